@@ -27,7 +27,7 @@ static void aie2_job_release(struct kref *ref)
 	if (job->out_fence)
 		dma_fence_put(job->out_fence);
 
-	kfree(job);
+	amdxdna_sched_job_free(job);
 
 	atomic64_inc(&ctx->job_free_cnt);
 	wake_up(&ctx->priv->job_free_waitq);
@@ -158,20 +158,47 @@ failed:
 	return ret;
 }
 
+/*
+ * Copy the counters to the status page. Submission, completion and failure
+ * publish concurrently, status_lock keeps the sequence count and counters
+ * coherent.
+ */
+static void aie2_ctx_status_publish(struct amdxdna_ctx *ctx, bool failed)
+{
+	struct amdxdna_ctx_status *status = ctx->priv->status_bo->mem.kva;
+	unsigned long flags;
+
+	spin_lock_irqsave(&ctx->priv->status_lock, flags);
+	if (failed)
+		ctx->errors++;
+	WRITE_ONCE(status->seq, ++ctx->priv->status_seq);
+	smp_wmb();
+	WRITE_ONCE(status->completed, ctx->completed);
+	WRITE_ONCE(status->submitted, ctx->submitted);
+	WRITE_ONCE(status->errors, ctx->errors);
+	smp_wmb();
+	WRITE_ONCE(status->seq, ++ctx->priv->status_seq);
+	spin_unlock_irqrestore(&ctx->priv->status_lock, flags);
+}
+
 static void
 aie2_sched_notify(struct amdxdna_sched_job *job)
 {
 	struct amdxdna_ctx *ctx = job->ctx;
 	struct dma_fence *fence = job->fence;
+	bool failed;
 	int idx;
 
-#ifdef AMDXDNA_DRM_USAGE
+	/* Charged always, client budgets and usage queries depend on it */
 	amdxdna_update_stats(ctx->client, ktime_get(), false);
-#endif
-	ctx->completed++;
 	trace_xdna_job(&job->base, ctx->name, "signaling fence", job->seq, job->opcode);
 	job->job_done = true;
+	failed = job->cmd_bo && amdxdna_cmd_get_state(job->cmd_bo) != ERT_CMD_STATE_COMPLETED;
 	dma_fence_signal(fence);
+	/* Whoever sees the new count must find the fence signaled */
+	smp_store_release(&ctx->completed, ctx->completed + 1);
+	WRITE_ONCE(*(u64 *)ctx->priv->completed_bo->mem.kva, ctx->completed);
+	aie2_ctx_status_publish(ctx, failed);
 	idx = get_job_idx(job->seq);
 	ctx->priv->pending[idx] = NULL;
 	up(&job->ctx->priv->job_sem);
@@ -301,6 +328,9 @@ aie2_sched_job_run(struct drm_sched_job *sched_job)
 
 	kref_get(&job->refcnt);
 	fence = dma_fence_get(job->fence);
+	/* Before sending, the response may come and notify before we return */
+	amdxdna_update_stats(ctx->client, ktime_get(), true);
+	job->charged = true;
 
 	switch (job->opcode) {
 	case OP_SYNC_BO:
@@ -325,15 +355,13 @@ aie2_sched_job_run(struct drm_sched_job *sched_job)
 
 out:
 	if (ret) {
+		job->charged = false;
+		amdxdna_update_stats(ctx->client, ktime_get(), false);
 		dma_fence_put(job->fence);
 		aie2_job_put(job);
 		mmput(job->mm);
 		fence = ERR_PTR(ret);
 	}
-#ifdef AMDXDNA_DRM_USAGE
-	else
-		amdxdna_update_stats(ctx->client, ktime_get(), true);
-#endif
 
 	return fence;
 }
@@ -351,6 +379,11 @@ static void aie2_sched_job_free(struct drm_sched_job *sched_job)
 		/* No contention with submit, no lock */
 		ctx->priv->pending[idx] = NULL;
 		up(&ctx->priv->job_sem);
+		/* Failed to run or never ran */
+		aie2_ctx_status_publish(ctx, true);
+		/* Ran but no response came, stop charging the client */
+		if (job->charged)
+			amdxdna_update_stats(ctx->client, ktime_get(), false);
 	}
 
 	drm_sched_job_cleanup(sched_job);
@@ -483,6 +516,51 @@ skip_list_cal:
 	return 0;
 }
 
+/*
+ * The completed counter is copied into device heap, which is mapped by user,
+ * so that user can check command completion without a syscall. All counters
+ * go to the status page, which user maps read-only, so that they can be
+ * trusted as much as what HW_CONTEXTS query returns.
+ */
+static int aie2_ctx_status_bo_create(struct amdxdna_ctx *ctx)
+{
+	struct amdxdna_client *client = ctx->client;
+	struct amdxdna_drm_create_bo args = {
+		.flags = 0,
+		.type = AMDXDNA_BO_DEV,
+		.vaddr = 0,
+		.size = sizeof(u64),
+	};
+	struct amdxdna_gem_obj *abo;
+
+	abo = amdxdna_drm_create_dev_bo(&client->xdna->ddev, &args, client->filp);
+	if (IS_ERR(abo))
+		return PTR_ERR(abo);
+
+	*(u64 *)abo->mem.kva = 0;
+	ctx->priv->completed_bo = abo;
+	ctx->completed_addr = abo->mem.userptr;
+
+	abo = amdxdna_gem_create_ro_bo(client, sizeof(struct amdxdna_ctx_status));
+	if (IS_ERR(abo)) {
+		drm_gem_object_put(to_gobj(ctx->priv->completed_bo));
+		ctx->priv->completed_bo = NULL;
+		return PTR_ERR(abo);
+	}
+
+	memset(abo->mem.kva, 0, sizeof(struct amdxdna_ctx_status));
+	spin_lock_init(&ctx->priv->status_lock);
+	ctx->priv->status_bo = abo;
+	ctx->status_offset = drm_vma_node_offset_addr(&to_gobj(abo)->vma_node);
+	return 0;
+}
+
+static void aie2_ctx_status_bo_destroy(struct amdxdna_ctx *ctx)
+{
+	amdxdna_gem_destroy_ro_bo(ctx->priv->status_bo);
+	drm_gem_object_put(to_gobj(ctx->priv->completed_bo));
+}
+
 int aie2_ctx_init(struct amdxdna_ctx *ctx)
 {
 	struct amdxdna_client *client = ctx->client;
@@ -542,6 +620,12 @@ int aie2_ctx_init(struct amdxdna_ctx *ctx)
 		priv->cmd_buf[i] = abo;
 	}
 
+	ret = aie2_ctx_status_bo_create(ctx);
+	if (ret) {
+		XDNA_ERR(xdna, "Create status bo failed, ret %d", ret);
+		goto free_cmd_bufs;
+	}
+
 	mutex_init(&priv->io_lock);
 	init_waitqueue_head(&priv->job_free_waitq);
 
@@ -572,6 +656,8 @@ int aie2_ctx_init(struct amdxdna_ctx *ctx)
 free_wq:
 	destroy_workqueue(priv->submit_wq);
 free_cmd_bufs:
+	if (priv->status_bo)
+		aie2_ctx_status_bo_destroy(ctx);
 	for (i = 0; i < ARRAY_SIZE(priv->cmd_buf); i++) {
 		if (!priv->cmd_buf[i])
 			continue;
@@ -598,6 +684,7 @@ void aie2_ctx_fini(struct amdxdna_ctx *ctx)
 	aie2_ctx_syncobj_destroy(ctx);
 	for (idx = 0; idx < ARRAY_SIZE(ctx->priv->cmd_buf); idx++)
 		drm_gem_object_put(to_gobj(ctx->priv->cmd_buf[idx]));
+	aie2_ctx_status_bo_destroy(ctx);
 	amdxdna_gem_unpin(ctx->priv->heap);
 	drm_gem_object_put(to_gobj(ctx->priv->heap));
 #ifdef AMDXDNA_DEVEL
@@ -643,7 +730,10 @@ static int aie2_ctx_cu_config(struct amdxdna_ctx *ctx, void *buf, u32 size)
 
 #ifdef AMDXDNA_DEVEL
 	if (priv_load) {
+		/* PDIs are shared with other contexts of the device */
+		mutex_lock(&xdna->dev_lock);
 		ret = aie2_register_pdis(ctx);
+		mutex_unlock(&xdna->dev_lock);
 		if (ret) {
 			XDNA_ERR(xdna, "Register PDIs failed, ret %d", ret);
 			goto free_cus;
@@ -680,7 +770,8 @@ static int aie2_ctx_attach_debug_bo(struct amdxdna_ctx *ctx, u32 bo_hdl)
 	}
 
 	ret = amdxdna_cmd_submit(client, OP_REG_DEBUG_BO, AMDXDNA_INVALID_BO_HANDLE,
-				 &bo_hdl, 1, NULL, NULL, 0, ctx->id, &seq);
+				 &bo_hdl, 1, AMDXDNA_INVALID_BO_LIST_HANDLE,
+				 NULL, NULL, 0, ctx->id, &seq);
 	if (ret) {
 		XDNA_ERR(xdna, "Submit command failed");
 		goto clear_ctx;
@@ -716,7 +807,8 @@ static int aie2_ctx_detach_debug_bo(struct amdxdna_ctx *ctx, u32 bo_hdl)
 	amdxdna_gem_clear_assigned_ctx(client, bo_hdl);
 
 	ret = amdxdna_cmd_submit(client, OP_UNREG_DEBUG_BO, AMDXDNA_INVALID_BO_HANDLE,
-				 &bo_hdl, 1, NULL, NULL, 0, ctx->id, &seq);
+				 &bo_hdl, 1, AMDXDNA_INVALID_BO_LIST_HANDLE,
+				 NULL, NULL, 0, ctx->id, &seq);
 	if (unlikely(ret)) {
 		XDNA_ERR(xdna, "Submit command failed");
 		return ret;
@@ -900,7 +992,14 @@ retry:
 		goto cleanup_job;
 	}
 
+	/*
+	 * BOs sharing a reservation object are only marked locked once, so
+	 * skipping the others reserves and fences each resv exactly once.
+	 */
 	for (i = 0; i < job->bo_cnt; i++) {
+		if (!job->bos[i].locked)
+			continue;
+
 		ret = dma_resv_reserve_fences(job->bos[i].obj->resv, 1);
 		if (ret) {
 			XDNA_WARN(xdna, "Failed to reserve fences %d", ret);
@@ -933,9 +1032,14 @@ retry:
 	mutex_lock(&ctx->priv->io_lock);
 	drm_sched_job_arm(&job->base);
 	job->out_fence = dma_fence_get(&job->base.s_fence->finished);
-	for (i = 0; i < job->bo_cnt; i++)
+	for (i = 0; i < job->bo_cnt; i++) {
+		if (!job->bos[i].locked)
+			continue;
+
 		dma_resv_add_fence(job->bos[i].obj->resv, job->out_fence, DMA_RESV_USAGE_WRITE);
+	}
 	job->seq = ctx->submitted++;
+	aie2_ctx_status_publish(ctx, false);
 	ctx->priv->pending[get_job_idx(job->seq)] = job;
 	kref_get(&job->refcnt);
 	drm_sched_entity_push_job(&job->base);
@@ -444,6 +444,9 @@ static ssize_t aie2_dbgfs_nputest(struct file *file, const char __user *ptr,
 	case 3:
 		ret = aie2_self_test(ndev);
 		break;
+	case 4:
+		ret = xdna_mailbox_copy_bench(ndev->mbox, argc >= 2 ? args[1] : 1000);
+		break;
 	default:
 		XDNA_ERR(ndev->xdna, "Unknown test case ID %d\n", args[0]);
 	}
@@ -458,7 +461,7 @@ static int aie2_dbgfs_nputest_show(struct seq_file *m, void *unused)
 {
 	seq_puts(m, "nputest usage:\n");
 	seq_puts(m, "\techo id [args] > <debugfs_path>/dri/<render_id>/nputest\n");
-	seq_puts(m, "\t\tid - test case id (1 - 2), bad id will be ignore\n");
+	seq_puts(m, "\t\tid - test case id (1 - 4), bad id will be ignore\n");
 	seq_puts(m, "\t\targs - arguments for test case, optional\n");
 	seq_puts(m, "\n");
 	seq_puts(m, "test case 1 usage:\n");
@@ -470,6 +473,10 @@ static int aie2_dbgfs_nputest_show(struct seq_file *m, void *unused)
 	seq_puts(m, "\t\tresp_len - response length in words (1 - 28)\n");
 	seq_puts(m, "\t\tpattern - data to fill message and response\n");
 	seq_puts(m, "\t\tcnt - send cnt messages without wait, optional (default 1)\n");
+	seq_puts(m, "\n");
+	seq_puts(m, "test case 4 usage:\n");
+	seq_puts(m, "\techo 4 [iters] > <nputest file>\n");
+	seq_puts(m, "\t\titers - copies per response size (16B - 4KB), optional (default 1000)\n");
 
 	return 0;
 }
@@ -4,6 +4,7 @@
  */
 
 #include <linux/kthread.h>
+#include <linux/xxhash.h>
 #include <drm/drm_cache.h>
 
 #include "drm_local/amdxdna_accel.h"
@@ -48,6 +49,53 @@ aie2_send_mgmt_msg_wait_offset(struct amdxdna_dev_hdl *ndev,
 	return ret;
 }
 
+/*
+ * Send independent management messages back to back and wait for all of them
+ * together. Firmware handles them in order. Status is at offset 0 of all the
+ * responses.
+ */
+static int aie2_send_mgmt_msgs_wait(struct amdxdna_dev_hdl *ndev,
+				    struct xdna_mailbox_msg **msgs, u32 cnt)
+{
+	struct amdxdna_dev *xdna = ndev->xdna;
+	struct xdna_notify *hdl;
+	int ret = 0, wret;
+	u32 i, sent;
+
+	if (!ndev->mgmt_chann)
+		return -ENODEV;
+
+	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
+	for (sent = 0; sent < cnt; sent++) {
+		ret = xdna_send_msg(xdna, ndev->mgmt_chann, msgs[sent]);
+		if (ret)
+			break;
+	}
+
+	/* Messages already sent use the buffers of caller, always wait for them */
+	wret = xdna_wait_msgs(xdna, msgs, sent);
+	if (wret == -ETIME) {
+		xdna_mailbox_stop_channel(ndev->mgmt_chann);
+		xdna_mailbox_destroy_channel(ndev->mgmt_chann);
+		ndev->mgmt_chann = NULL;
+	}
+	if (!ret)
+		ret = wret;
+	if (ret)
+		return ret;
+
+	for (i = 0; i < cnt; i++) {
+		hdl = msgs[i]->handle;
+		if (hdl->data[0] != AIE2_STATUS_SUCCESS) {
+			XDNA_ERR(xdna, "command opcode 0x%x failed, status 0x%x",
+				 msgs[i]->opcode, hdl->data[0]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 int aie2_suspend_fw(struct amdxdna_dev_hdl *ndev)
 {
 	DECLARE_AIE2_MSG(suspend, MSG_OP_SUSPEND);
@@ -62,37 +110,93 @@ int aie2_resume_fw(struct amdxdna_dev_hdl *ndev)
 	return aie2_send_mgmt_msg_wait(ndev, &msg);
 }
 
-int aie2_set_runtime_cfg(struct amdxdna_dev_hdl *ndev, u32 type, u64 value)
+/*
+ * Firmware takes one config per message. Send all of them back to back and
+ * wait once. The firmware value of each config is updated by its own status,
+ * so a failed batch leaves the failed ones unknown.
+ */
+int aie2_set_runtime_cfgs(struct amdxdna_dev_hdl *ndev, struct aie2_rt_cfg **cfgs,
+			  const u64 *values, u32 cnt)
 {
-	DECLARE_AIE2_MSG(set_runtime_cfg, MSG_OP_SET_RUNTIME_CONFIG);
+	struct {
+		struct set_runtime_cfg_req	req;
+		struct set_runtime_cfg_resp	resp;
+		struct xdna_notify		hdl;
+		struct xdna_mailbox_msg		msg;
+	} *batch;
+	struct xdna_mailbox_msg *msgs[AIE2_MAX_RT_CFGS];
 	int ret;
+	u32 i;
 
-	req.type = type;
-	req.value = value;
+	if (WARN_ON(cnt > AIE2_MAX_RT_CFGS))
+		return -EINVAL;
 
-	ret = aie2_send_mgmt_msg_wait(ndev, &msg);
-	if (ret) {
+	batch = kcalloc(cnt, sizeof(*batch), GFP_KERNEL);
+	if (!batch)
+		return -ENOMEM;
+
+	for (i = 0; i < cnt; i++) {
+		batch[i].req.type = cfgs[i]->cfg->type;
+		batch[i].req.value = values[i];
+		batch[i].resp.status = MAX_AIE2_STATUS_CODE;
+		xdna_msg_init(&batch[i].msg, &batch[i].hdl, MSG_OP_SET_RUNTIME_CONFIG,
+			      &batch[i].req, sizeof(batch[i].req),
+			      &batch[i].resp, sizeof(batch[i].resp));
+		msgs[i] = &batch[i].msg;
+	}
+
+	ret = aie2_send_mgmt_msgs_wait(ndev, msgs, cnt);
+	if (ret)
 		XDNA_ERR(ndev->xdna, "Failed to set runtime config, ret %d", ret);
-		return ret;
+
+	for (i = 0; i < cnt; i++) {
+		cfgs[i]->fw_known = batch[i].resp.status == AIE2_STATUS_SUCCESS;
+		cfgs[i]->fw_value = values[i];
 	}
 
-	return 0;
+	kfree(batch);
+	return ret;
 }
 
-int aie2_get_runtime_cfg(struct amdxdna_dev_hdl *ndev, u32 type, u64 *value)
+int aie2_get_runtime_cfgs(struct amdxdna_dev_hdl *ndev, struct aie2_rt_cfg **cfgs, u32 cnt)
 {
-	DECLARE_AIE2_MSG(get_runtime_cfg, MSG_OP_GET_RUNTIME_CONFIG);
+	struct {
+		struct get_runtime_cfg_req	req;
+		struct get_runtime_cfg_resp	resp;
+		struct xdna_notify		hdl;
+		struct xdna_mailbox_msg		msg;
+	} *batch;
+	struct xdna_mailbox_msg *msgs[AIE2_MAX_RT_CFGS];
 	int ret;
+	u32 i;
 
-	req.type = type;
-	ret = aie2_send_mgmt_msg_wait(ndev, &msg);
-	if (ret) {
-		XDNA_ERR(ndev->xdna, "Failed to get runtime config, ret %d", ret);
-		return ret;
+	if (WARN_ON(cnt > AIE2_MAX_RT_CFGS))
+		return -EINVAL;
+
+	batch = kcalloc(cnt, sizeof(*batch), GFP_KERNEL);
+	if (!batch)
+		return -ENOMEM;
+
+	for (i = 0; i < cnt; i++) {
+		batch[i].req.type = cfgs[i]->cfg->type;
+		batch[i].resp.status = MAX_AIE2_STATUS_CODE;
+		xdna_msg_init(&batch[i].msg, &batch[i].hdl, MSG_OP_GET_RUNTIME_CONFIG,
+			      &batch[i].req, sizeof(batch[i].req),
+			      &batch[i].resp, sizeof(batch[i].resp));
+		msgs[i] = &batch[i].msg;
 	}
 
-	*value = resp.value;
-	return 0;
+	ret = aie2_send_mgmt_msgs_wait(ndev, msgs, cnt);
+	if (ret)
+		XDNA_DBG(ndev->xdna, "Failed to get runtime config, ret %d", ret);
+
+	for (i = 0; i < cnt; i++) {
+		cfgs[i]->fw_known = batch[i].resp.status == AIE2_STATUS_SUCCESS;
+		cfgs[i]->fw_value = batch[i].resp.value;
+	}
+
+	kfree(batch);
+	return ret;
 }
 
 int aie2_check_protocol_version(struct amdxdna_dev_hdl *ndev)
@@ -158,59 +262,75 @@ int aie2_assign_mgmt_pasid(struct amdxdna_dev_hdl *ndev, u16 pasid)
 	return aie2_send_mgmt_msg_wait(ndev, &msg);
 }
 
-int aie2_query_aie_version(struct amdxdna_dev_hdl *ndev, struct aie_version *version)
+static void aie2_fill_aie_metadata(struct aie_metadata *metadata,
+				   const struct aie_tile_info *info)
 {
-	DECLARE_AIE2_MSG(aie_version_info, MSG_OP_QUERY_AIE_VERSION);
-	struct amdxdna_dev *xdna = ndev->xdna;
-	int ret;
-
-	ret = aie2_send_mgmt_msg_wait(ndev, &msg);
-	if (ret)
-		return ret;
-
-	XDNA_DBG(xdna, "Query AIE version - major: %u minor: %u completed",
-		 resp.major, resp.minor);
-
-	version->major = resp.major;
-	version->minor = resp.minor;
-
-	return 0;
+	metadata->size = info->size;
+	metadata->cols = info->cols;
+	metadata->rows = info->rows;
+
+	metadata->version.major = info->major;
+	metadata->version.minor = info->minor;
+
+	metadata->core.row_count = info->core_rows;
+	metadata->core.row_start = info->core_row_start;
+	metadata->core.dma_channel_count = info->core_dma_channels;
+	metadata->core.lock_count = info->core_locks;
+	metadata->core.event_reg_count = info->core_events;
+
+	metadata->mem.row_count = info->mem_rows;
+	metadata->mem.row_start = info->mem_row_start;
+	metadata->mem.dma_channel_count = info->mem_dma_channels;
+	metadata->mem.lock_count = info->mem_locks;
+	metadata->mem.event_reg_count = info->mem_events;
+
+	metadata->shim.row_count = info->shim_rows;
+	metadata->shim.row_start = info->shim_row_start;
+	metadata->shim.dma_channel_count = info->shim_dma_channels;
+	metadata->shim.lock_count = info->shim_locks;
+	metadata->shim.event_reg_count = info->shim_events;
 }
 
-int aie2_query_aie_metadata(struct amdxdna_dev_hdl *ndev, struct aie_metadata *metadata)
+/* Query firmware version, AIE version and AIE metadata in one round trip */
+int aie2_query_firmware_info(struct amdxdna_dev_hdl *ndev)
 {
-	DECLARE_AIE2_MSG(aie_tile_info, MSG_OP_QUERY_AIE_TILE_INFO);
-	int ret;
+	struct firmware_version_resp fw_resp = { MAX_AIE2_STATUS_CODE };
+	struct aie_version_info_resp ver_resp = { MAX_AIE2_STATUS_CODE };
+	struct aie_tile_info_resp tile_resp = { MAX_AIE2_STATUS_CODE };
+	struct firmware_version_req fw_req = { 0 };
+	struct aie_version_info_req ver_req = { 0 };
+	struct aie_tile_info_req tile_req = { 0 };
+	struct xdna_mailbox_msg msg[3] = {}, *msgs[3];
+	struct amdxdna_dev *xdna = ndev->xdna;
+	struct amdxdna_fw_ver *fw_ver;
+	struct xdna_notify hdl[3];
+	int ret, i;
 
-	ret = aie2_send_mgmt_msg_wait(ndev, &msg);
+	xdna_msg_init(&msg[0], &hdl[0], MSG_OP_GET_FIRMWARE_VERSION,
+		      &fw_req, sizeof(fw_req), &fw_resp, sizeof(fw_resp));
+	xdna_msg_init(&msg[1], &hdl[1], MSG_OP_QUERY_AIE_VERSION,
+		      &ver_req, sizeof(ver_req), &ver_resp, sizeof(ver_resp));
+	xdna_msg_init(&msg[2], &hdl[2], MSG_OP_QUERY_AIE_TILE_INFO,
+		      &tile_req, sizeof(tile_req), &tile_resp, sizeof(tile_resp));
+	for (i = 0; i < ARRAY_SIZE(msgs); i++)
+		msgs[i] = &msg[i];
+
+	ret = aie2_send_mgmt_msgs_wait(ndev, msgs, ARRAY_SIZE(msgs));
 	if (ret)
 		return ret;
 
-	metadata->size = resp.info.size;
-	metadata->cols = resp.info.cols;
-	metadata->rows = resp.info.rows;
-
-	metadata->version.major = resp.info.major;
-	metadata->version.minor = resp.info.minor;
+	fw_ver = &xdna->fw_ver;
+	fw_ver->major = fw_resp.major;
+	fw_ver->minor = fw_resp.minor;
+	fw_ver->sub = fw_resp.sub;
+	fw_ver->build = fw_resp.build;
 
-	metadata->core.row_count = resp.info.core_rows;
-	metadata->core.row_start = resp.info.core_row_start;
-	metadata->core.dma_channel_count = resp.info.core_dma_channels;
-	metadata->core.lock_count = resp.info.core_locks;
-	metadata->core.event_reg_count = resp.info.core_events;
-
-	metadata->mem.row_count = resp.info.mem_rows;
-	metadata->mem.row_start = resp.info.mem_row_start;
-	metadata->mem.dma_channel_count = resp.info.mem_dma_channels;
-	metadata->mem.lock_count = resp.info.mem_locks;
-	metadata->mem.event_reg_count = resp.info.mem_events;
-
-	metadata->shim.row_count = resp.info.shim_rows;
-	metadata->shim.row_start = resp.info.shim_row_start;
-	metadata->shim.dma_channel_count = resp.info.shim_dma_channels;
-	metadata->shim.lock_count = resp.info.shim_locks;
-	metadata->shim.event_reg_count = resp.info.shim_events;
+	XDNA_DBG(xdna, "Query AIE version - major: %u minor: %u completed",
+		 ver_resp.major, ver_resp.minor);
+	ndev->version.major = ver_resp.major;
+	ndev->version.minor = ver_resp.minor;
 
+	aie2_fill_aie_metadata(&ndev->metadata, &tile_resp.info);
 	return 0;
 }
 
@@ -369,6 +489,58 @@ int aie2_self_test(struct amdxdna_dev_hdl *ndev)
 }
 #endif
 
+/* Larger query buffers are not kept around */
+#define AIE2_QUERY_BUF_MAX_SIZE	SZ_1M
+
+/*
+ * Get a DMA buffer of at least size bytes for a query. The device keeps one
+ * buffer, grown on demand, so that polling queries don't map and unmap memory
+ * every time. Release it with aie2_query_buf_put().
+ */
+void *aie2_query_buf_get(struct amdxdna_dev_hdl *ndev, size_t size, dma_addr_t *dma_addr)
+{
+	struct amdxdna_dev *xdna = ndev->xdna;
+	void *buf;
+
+	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
+	size = PAGE_ALIGN(size);
+	if (size <= ndev->query_buf_size) {
+		*dma_addr = ndev->query_buf_dma;
+		return ndev->query_buf;
+	}
+
+	buf = dma_alloc_noncoherent(xdna->ddev.dev, size, dma_addr,
+				    DMA_FROM_DEVICE, GFP_KERNEL);
+	if (!buf || size > AIE2_QUERY_BUF_MAX_SIZE)
+		return buf;
+
+	aie2_query_buf_fini(ndev);
+	ndev->query_buf = buf;
+	ndev->query_buf_dma = *dma_addr;
+	ndev->query_buf_size = size;
+	XDNA_DBG(xdna, "Query buffer grown to 0x%lx", size);
+	return buf;
+}
+
+void aie2_query_buf_put(struct amdxdna_dev_hdl *ndev, void *buf, size_t size,
+			dma_addr_t dma_addr)
+{
+	if (buf != ndev->query_buf)
+		dma_free_noncoherent(ndev->xdna->ddev.dev, PAGE_ALIGN(size), buf,
+				     dma_addr, DMA_FROM_DEVICE);
+}
+
+void aie2_query_buf_fini(struct amdxdna_dev_hdl *ndev)
+{
+	if (!ndev->query_buf)
+		return;
+
+	dma_free_noncoherent(ndev->xdna->ddev.dev, ndev->query_buf_size, ndev->query_buf,
+			     ndev->query_buf_dma, DMA_FROM_DEVICE);
+	ndev->query_buf = NULL;
+	ndev->query_buf_size = 0;
+}
+
 int aie2_query_status(struct amdxdna_dev_hdl *ndev, char __user *buf,
 		      u32 size, u32 *cols_filled)
 {
@@ -382,8 +554,7 @@ int aie2_query_status(struct amdxdna_dev_hdl *ndev, char __user *buf,
 	u8 *buff_addr;
 	int ret, idx;
 
-	buff_addr = dma_alloc_noncoherent(xdna->ddev.dev, size, &dma_addr,
-					  DMA_FROM_DEVICE, GFP_KERNEL);
+	buff_addr = aie2_query_buf_get(ndev, size, &dma_addr);
 	if (!buff_addr)
 		return -ENOMEM;
 
@@ -430,7 +601,7 @@ int aie2_query_status(struct amdxdna_dev_hdl *ndev, char __user *buf,
 	*cols_filled = aie_bitmap;
 
 fail:
-	dma_free_noncoherent(xdna->ddev.dev, size, buff_addr, dma_addr, DMA_FROM_DEVICE);
+	aie2_query_buf_put(ndev, buff_addr, size, dma_addr);
 	return ret;
 }
 
@@ -912,15 +1083,208 @@ int aie2_config_debug_bo(struct amdxdna_ctx *ctx, struct amdxdna_sched_job *job,
 }
 
 #ifdef AMDXDNA_DEVEL
+static void aie2_pdi_free(struct amdxdna_dev *xdna, struct aie2_pdi *pdi)
+{
+	dma_free_noncoherent(xdna->ddev.dev, pdi->size, pdi->addr,
+			     pdi->dma_addr, DMA_TO_DEVICE);
+	ida_free(&xdna->pdi_ida, pdi->id);
+	kfree(pdi);
+}
+
+/*
+ * Get the PDI with the content of abo. A PDI no context of the device has yet
+ * is created unregistered, see aie2_pdi_register().
+ */
+static struct aie2_pdi *aie2_pdi_get(struct amdxdna_dev_hdl *ndev,
+				     struct amdxdna_gem_obj *abo)
+{
+	size_t size = to_gobj(abo)->size;
+	struct amdxdna_dev *xdna = ndev->xdna;
+	struct aie2_pdi *pdi;
+	u64 hash;
+	int ret;
+
+	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
+	hash = xxh64(abo->mem.kva, size, 0);
+	hash_for_each_possible(ndev->pdi_hash, pdi, node, hash) {
+		if (pdi->hash != hash || pdi->size != size ||
+		    memcmp(pdi->addr, abo->mem.kva, size))
+			continue;
+
+		pdi->refcnt++;
+		XDNA_DBG(xdna, "PDI %d shared, refcnt %d", pdi->id, pdi->refcnt);
+		return pdi;
+	}
+
+	pdi = kzalloc(sizeof(*pdi), GFP_KERNEL);
+	if (!pdi)
+		return ERR_PTR(-ENOMEM);
+
+	pdi->id = ida_alloc_range(&xdna->pdi_ida, 0, AIE2_MAX_PDI_ID, GFP_KERNEL);
+	if (pdi->id < 0) {
+		XDNA_ERR(xdna, "Cannot allocate PDI id");
+		ret = pdi->id;
+		goto free_pdi;
+	}
+
+	pdi->size = size;
+	pdi->addr = dma_alloc_noncoherent(xdna->ddev.dev, pdi->size, &pdi->dma_addr,
+					  DMA_TO_DEVICE, GFP_KERNEL);
+	if (!pdi->addr) {
+		ret = -ENOMEM;
+		goto free_id;
+	}
+	memcpy(pdi->addr, abo->mem.kva, size);
+	drm_clflush_virt_range(pdi->addr, pdi->size); /* device can access */
+
+	pdi->hash = hash;
+	pdi->refcnt = 1;
+	hash_add(ndev->pdi_hash, &pdi->node, hash);
+	return pdi;
+
+free_id:
+	ida_free(&xdna->pdi_ida, pdi->id);
+free_pdi:
+	kfree(pdi);
+	return ERR_PTR(ret);
+}
+
+#define AIE2_MAX_PDI_MSGS	DIV_ROUND_UP(MAX_NUM_CUS, AIE2_MAX_PDI_INFOS)
+
+/*
+ * Register PDIs, AIE2_MAX_PDI_INFOS per message with all the messages in
+ * flight together. PDIs of the messages that succeeded are marked registered
+ * even on failure, so that they can be unregistered.
+ */
+static int aie2_pdi_register(struct amdxdna_dev_hdl *ndev, struct aie2_pdi **pdis, u32 cnt)
+{
+	struct {
+		struct register_pdi_req		req;
+		struct register_pdi_resp	resp;
+		struct xdna_notify		hdl;
+		struct xdna_mailbox_msg		msg;
+	} *batch;
+	struct xdna_mailbox_msg *msgs[AIE2_MAX_PDI_MSGS];
+	u32 nr = DIV_ROUND_UP(cnt, AIE2_MAX_PDI_INFOS);
+	struct amdxdna_dev *xdna = ndev->xdna;
+	struct pdi_info *info;
+	int ret;
+	u32 i;
+
+	if (WARN_ON(nr > AIE2_MAX_PDI_MSGS))
+		return -EINVAL;
+
+	batch = kcalloc(nr, sizeof(*batch), GFP_KERNEL);
+	if (!batch)
+		return -ENOMEM;
+
+	for (i = 0; i < cnt; i++) {
+		info = &batch[i / AIE2_MAX_PDI_INFOS].req.pdi_info[i % AIE2_MAX_PDI_INFOS];
+		info->pdi_id = pdis[i]->id;
+		info->address = pdis[i]->dma_addr;
+		info->size = pdis[i]->size;
+		info->type = 3;
+		batch[i / AIE2_MAX_PDI_INFOS].req.num_infos++;
+	}
+	for (i = 0; i < nr; i++) {
+		batch[i].resp.status = MAX_AIE2_STATUS_CODE;
+		xdna_msg_init(&batch[i].msg, &batch[i].hdl, MSG_OP_REGISTER_PDI,
+			      &batch[i].req, sizeof(batch[i].req),
+			      &batch[i].resp, sizeof(batch[i].resp));
+		msgs[i] = &batch[i].msg;
+	}
+
+	ret = aie2_send_mgmt_msgs_wait(ndev, msgs, nr);
+	if (ret)
+		XDNA_ERR(xdna, "Register %d PDIs failed, ret %d", cnt, ret);
+
+	for (i = 0; i < cnt; i++) {
+		if (batch[i / AIE2_MAX_PDI_INFOS].resp.status != AIE2_STATUS_SUCCESS)
+			continue;
+
+		WARN_ONCE(!(i % AIE2_MAX_PDI_INFOS) &&
+			  pdis[i]->id != batch[i / AIE2_MAX_PDI_INFOS].resp.reg_index,
+			  "PDI ID and FW registered index mismatch");
+		pdis[i]->registered = true;
+	}
+
+	XDNA_DBG(xdna, "Register %d PDIs in %d messages, ret %d", cnt, nr, ret);
+	kfree(batch);
+	return ret;
+}
+
+/*
+ * Unregister PDIs the same way as aie2_pdi_register() and free them. PDIs
+ * firmware failed to unregister may still be accessed, they are leaked.
+ */
+static void aie2_pdi_unregister(struct amdxdna_dev_hdl *ndev, struct aie2_pdi **pdis, u32 cnt)
+{
+	struct {
+		struct unregister_pdi_req	req;
+		struct unregister_pdi_resp	resp;
+		struct xdna_notify		hdl;
+		struct xdna_mailbox_msg		msg;
+	} *batch;
+	struct xdna_mailbox_msg *msgs[AIE2_MAX_PDI_MSGS];
+	u32 nr = DIV_ROUND_UP(cnt, AIE2_MAX_PDI_INFOS);
+	struct amdxdna_dev *xdna = ndev->xdna;
+	int ret;
+	u32 i;
+
+	if (WARN_ON(nr > AIE2_MAX_PDI_MSGS))
+		return;
+
+	batch = kcalloc(nr, sizeof(*batch), GFP_KERNEL);
+	if (!batch) {
+		XDNA_ERR(xdna, "No memory to unregister %d PDIs", cnt);
+		return;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		batch[i / AIE2_MAX_PDI_INFOS].req.pdi_id[i % AIE2_MAX_PDI_INFOS] = pdis[i]->id;
+		batch[i / AIE2_MAX_PDI_INFOS].req.num_pdi++;
+	}
+	for (i = 0; i < nr; i++) {
+		batch[i].resp.status = MAX_AIE2_STATUS_CODE;
+		xdna_msg_init(&batch[i].msg, &batch[i].hdl, MSG_OP_UNREGISTER_PDI,
+			      &batch[i].req, sizeof(batch[i].req),
+			      &batch[i].resp, sizeof(batch[i].resp));
+		msgs[i] = &batch[i].msg;
+	}
+
+	ret = aie2_send_mgmt_msgs_wait(ndev, msgs, nr);
+	if (ret)
+		XDNA_ERR(xdna, "Unregister %d PDIs failed, ret %d", cnt, ret);
+
+	for (i = 0; i < cnt; i++) {
+		if (batch[i / AIE2_MAX_PDI_INFOS].resp.status == AIE2_STATUS_SUCCESS)
+			aie2_pdi_free(xdna, pdis[i]);
+	}
+
+	XDNA_DBG(xdna, "Unregister %d PDIs in %d messages, ret %d", cnt, nr, ret);
+	kfree(batch);
+}
+
+static bool aie2_pdi_in(struct aie2_pdi **pdis, u32 cnt, struct aie2_pdi *pdi)
+{
+	u32 i;
+
+	for (i = 0; i < cnt; i++) {
+		if (pdis[i] == pdi)
+			return true;
+	}
+	return false;
+}
+
 int aie2_register_pdis(struct amdxdna_ctx *ctx)
 {
-	DECLARE_AIE2_MSG(register_pdi, MSG_OP_REGISTER_PDI);
 	struct amdxdna_dev *xdna = ctx->client->xdna;
 	struct amdxdna_dev_hdl *ndev = xdna->dev_handle;
+	struct aie2_pdi *fresh[MAX_NUM_CUS];
 	int num_cus = ctx->cus->num_cus;
-	struct drm_gem_object *gobj;
 	struct amdxdna_gem_obj *abo;
-	struct ctx_pdi *pdi;
+	struct aie2_pdi *pdi;
+	u32 fresh_cnt = 0;
 	int i, ret;
 
 	if (num_cus > MAX_NUM_CUS) {
@@ -928,69 +1292,40 @@ int aie2_register_pdis(struct amdxdna_ctx *ctx)
 		return -EINVAL;
 	}
 
-	ctx->priv->pdi_infos = kcalloc(num_cus, sizeof(*ctx->priv->pdi_infos), GFP_KERNEL);
-	if (!ctx->priv->pdi_infos)
+	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
+	ctx->priv->pdis = kcalloc(num_cus, sizeof(*ctx->priv->pdis), GFP_KERNEL);
+	if (!ctx->priv->pdis)
 		return -ENOMEM;
 
-	req.num_infos = 1;
 	for (i = 0; i < num_cus; i++) {
 		struct amdxdna_cu_config *cu = &ctx->cus->cu_configs[i];
 
-		pdi = &ctx->priv->pdi_infos[i];
-		gobj = drm_gem_object_lookup(ctx->client->filp, cu->cu_bo);
-		if (!gobj) {
-			XDNA_ERR(xdna, "Lookup GEM object failed");
+		abo = amdxdna_gem_get_obj(ctx->client, cu->cu_bo, AMDXDNA_BO_DEV);
+		if (!abo || !abo->mem.kva) {
+			XDNA_ERR(xdna, "Invalid PDI BO %d", cu->cu_bo);
+			if (abo)
+				amdxdna_gem_put_obj(abo);
 			ret = -EINVAL;
 			goto cleanup;
 		}
-		abo = to_xdna_obj(gobj);
 
-		if (abo->type != AMDXDNA_BO_DEV) {
-			drm_gem_object_put(gobj);
-			XDNA_ERR(xdna, "Invalid BO type");
-			ret = -EINVAL;
-			goto cleanup;
-		}
-
-		pdi->id = -1; /* Set to negative value, so that cleanup can work */
-		pdi->id = ida_alloc_range(&xdna->pdi_ida, 0, AIE2_MAX_PDI_ID, GFP_KERNEL);
-		if (pdi->id < 0) {
-			XDNA_ERR(xdna, "Cannot allocate PDI id");
-			ret = pdi->id;
-			goto cleanup;
-		}
-		pdi->size = gobj->size;
-		pdi->addr = dma_alloc_noncoherent(xdna->ddev.dev, pdi->size, &pdi->dma_addr,
-						  DMA_TO_DEVICE, GFP_KERNEL);
-		if (!pdi->addr) {
-			drm_gem_object_put(gobj);
-			ret = -ENOMEM;
+		pdi = aie2_pdi_get(ndev, abo);
+		amdxdna_gem_put_obj(abo);
+		if (IS_ERR(pdi)) {
+			ret = PTR_ERR(pdi);
 			goto cleanup;
 		}
+		ctx->priv->pdis[i] = pdi;
 
-		if (copy_from_user(pdi->addr, u64_to_user_ptr(abo->mem.userptr), pdi->size)) {
-			drm_gem_object_put(gobj);
-			ret = -EFAULT;
-			goto cleanup;
-		}
+		/* Several CUs may share a PDI */
+		if (!pdi->registered && !aie2_pdi_in(fresh, fresh_cnt, pdi))
+			fresh[fresh_cnt++] = pdi;
+	}
 
-		drm_gem_object_put(gobj);
-		req.pdi_info.pdi_id = pdi->id;
-		req.pdi_info.address = pdi->dma_addr;
-		req.pdi_info.size = pdi->size;
-		req.pdi_info.type = 3;
-		resp.status = MAX_AIE2_STATUS_CODE;
-
-		drm_clflush_virt_range(pdi->addr, pdi->size); /* device can access */
-		ret = aie2_send_mgmt_msg_wait(ndev, &msg);
-		if (ret) {
-			XDNA_ERR(xdna, "PDI %d register failed, ret %d", pdi->id, ret);
+	if (fresh_cnt) {
+		ret = aie2_pdi_register(ndev, fresh, fresh_cnt);
+		if (ret)
 			goto cleanup;
-		}
-
-		pdi->registered = 1;
-		WARN_ONCE(pdi->id != resp.reg_index, "PDI ID and FW registered index mismatch");
-		XDNA_DBG(xdna, "PDI %d register completed, index %d", pdi->id, resp.reg_index);
 	}
 
 	return 0;
@@ -1002,40 +1337,33 @@ cleanup:
 
 int aie2_unregister_pdis(struct amdxdna_ctx *ctx)
 {
-	DECLARE_AIE2_MSG(unregister_pdi, MSG_OP_UNREGISTER_PDI);
 	struct amdxdna_dev *xdna = ctx->client->xdna;
-	struct amdxdna_dev_hdl *ndev = xdna->dev_handle;
-	int num_cus = ctx->cus->num_cus;
-	struct ctx_pdi *pdi;
-	int ret, i;
-
-	req.num_pdi = 1;
-	for (i = 0; i < num_cus; i++) {
-		pdi = &ctx->priv->pdi_infos[i];
-
-		if (pdi->registered) {
-			req.pdi_id = pdi->id;
-			resp.status = MAX_AIE2_STATUS_CODE;
-			ret = aie2_send_mgmt_msg_wait(ndev, &msg);
-			if (ret) {
-				XDNA_ERR(xdna, "PDI %d unregister failed, ret %d",
-					 pdi->id, ret);
-				break;
-			}
-
-			pdi->registered = 0;
-			XDNA_DBG(xdna, "PDI %d unregister completed", pdi->id);
-		}
+	struct aie2_pdi *dead[MAX_NUM_CUS];
+	struct aie2_pdi *pdi;
+	u32 dead_cnt = 0;
+	int i;
 
-		if (pdi->addr)
-			dma_free_noncoherent(xdna->ddev.dev, pdi->size, pdi->addr,
-					     pdi->dma_addr, DMA_TO_DEVICE);
+	if (!ctx->priv->pdis)
+		return 0;
 
-		if (pdi->id >= 0)
-			ida_free(&xdna->pdi_ida, pdi->id);
+	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
+	for (i = 0; i < ctx->cus->num_cus; i++) {
+		pdi = ctx->priv->pdis[i];
+		if (!pdi || --pdi->refcnt)
+			continue;
+
+		hash_del(&pdi->node);
+		if (pdi->registered)
+			dead[dead_cnt++] = pdi;
+		else
+			aie2_pdi_free(xdna, pdi);
 	}
 
-	kfree(ctx->priv->pdi_infos);
+	if (dead_cnt)
+		aie2_pdi_unregister(xdna->dev_handle, dead, dead_cnt);
+
+	kfree(ctx->priv->pdis);
+	ctx->priv->pdis = NULL;
 	return 0;
 }
 
@@ -1060,7 +1388,7 @@ int aie2_legacy_config_cu(struct amdxdna_ctx *ctx)
 
 		req.configs[i].cu_idx = i;
 		req.configs[i].cu_func = cu->cu_func;
-		req.configs[i].cu_pdi_id = ctx->priv->pdi_infos[i].id;
+		req.configs[i].cu_pdi_id = ctx->priv->pdis[i]->id;
 	}
 
 	ret = xdna_send_msg_wait(xdna, chann, &msg);
@@ -500,14 +500,12 @@ struct pdi_info {
 	u8		pdi_id;
 } __packed;
 
+/* Number of PDIs one register or unregister message can carry */
+#define AIE2_MAX_PDI_INFOS	8
 struct register_pdi_req {
 	u32			num_infos;
-	struct pdi_info		pdi_info;
-	/*
-	 * sizeof(pdi_info) is 29 bytes, pad 7 pdi_info
-	 * total = 7 * 29 = 203 bytes
-	 */
-	u8			pad[203];
+	/* sizeof(pdi_info) is 29 bytes */
+	struct pdi_info		pdi_info[AIE2_MAX_PDI_INFOS];
 } __packed;
 
 struct register_pdi_resp {
@@ -519,8 +517,7 @@ struct register_pdi_resp {
 
 struct unregister_pdi_req {
 	u32			num_pdi;
-	u8			pdi_id;
-	u8			pad[7];
+	u8			pdi_id[AIE2_MAX_PDI_INFOS];
 } __packed;
 
 struct unregister_pdi_resp {
@@ -187,34 +187,91 @@ done:
 	return ret;
 }
 
+static int aie2_rt_cfg_init(struct amdxdna_dev_hdl *ndev)
+{
+	struct amdxdna_dev *xdna = ndev->xdna;
+	const struct rt_config *cfg;
+	u32 cnt = 0, i;
+
+	for (cfg = ndev->priv->rt_config; cfg->type; cfg++)
+		cnt++;
+	if (cnt > AIE2_MAX_RT_CFGS) {
+		XDNA_ERR(xdna, "Too many runtime configs %d", cnt);
+		return -EINVAL;
+	}
+
+	ndev->rt_cfg = devm_kcalloc(xdna->ddev.dev, cnt, sizeof(*ndev->rt_cfg), GFP_KERNEL);
+	if (!ndev->rt_cfg)
+		return -ENOMEM;
+
+	for (i = 0; i < cnt; i++)
+		ndev->rt_cfg[i].cfg = &ndev->priv->rt_config[i];
+	ndev->rt_cfg_cnt = cnt;
+	return 0;
+}
+
+/*
+ * Firmware keeps its configs across suspend but not across power off. Read
+ * back all of them after firmware starts, so aie2_runtime_cfg() only sends
+ * what differs. Configs firmware fails to report are sent as before.
+ */
+static void aie2_rt_cfg_sync(struct amdxdna_dev_hdl *ndev)
+{
+	struct aie2_rt_cfg *cfgs[AIE2_MAX_RT_CFGS];
+	u32 i;
+
+	for (i = 0; i < ndev->rt_cfg_cnt; i++)
+		cfgs[i] = &ndev->rt_cfg[i];
+
+	aie2_get_runtime_cfgs(ndev, cfgs, ndev->rt_cfg_cnt);
+}
+
 int aie2_runtime_cfg(struct amdxdna_dev_hdl *ndev,
 		     enum rt_config_category category, u32 *val)
 {
+	struct aie2_rt_cfg *cfgs[AIE2_MAX_RT_CFGS];
+	u64 values[AIE2_MAX_RT_CFGS];
 	const struct rt_config *cfg;
-	u32 value;
+	struct aie2_rt_cfg *rt;
+	u32 value, cnt = 0;
 	int ret;
+	u32 i;
 
-	for (cfg = ndev->priv->rt_config; cfg->type; cfg++) {
+	for (i = 0; i < ndev->rt_cfg_cnt; i++) {
+		rt = &ndev->rt_cfg[i];
+		cfg = rt->cfg;
 		if (cfg->category != category)
 			continue;
 
 		value = val ? *val : cfg->value;
 #ifdef AMDXDNA_DEVEL
 		if (priv_load && cfg->type == ndev->priv->priv_load_cfg.type) {
-			cfg = &ndev->priv->priv_load_cfg;
-			value = cfg->value;
+			value = ndev->priv->priv_load_cfg.value;
 			XDNA_INFO(ndev->xdna, "Set runtime type %d value %d",
-				  cfg->type, cfg->value);
+				  cfg->type, value);
 		}
 #endif
-		ret = aie2_set_runtime_cfg(ndev, cfg->type, value);
-		if (ret) {
-			XDNA_ERR(ndev->xdna, "Set runtime type %d value %d failed",
-				 cfg->type, value);
-			return ret;
-		}
+		/* Force preemption value names a context, it is a request not a setting */
+		if (category != AIE2_RT_CFG_FORCE_PREEMPTION &&
+		    rt->fw_known && rt->fw_value == value)
+			continue;
+
+		cfgs[cnt] = rt;
+		values[cnt] = value;
+		cnt++;
 	}
 
+	if (!cnt)
+		return 0;
+
+	ret = aie2_set_runtime_cfgs(ndev, cfgs, values, cnt);
+	if (ret) {
+		XDNA_ERR(ndev->xdna, "Set %d runtime configs of category %d failed",
+			 cnt, category);
+		return ret;
+	}
+
+	XDNA_DBG(ndev->xdna, "Set %d runtime configs of category %d", cnt, category);
 	return 0;
 }
 
@@ -292,28 +349,60 @@ static int aie2_mgmt_fw_init(struct amdxdna_dev_hdl *ndev)
 	return 0;
 }
 
-static int aie2_mgmt_fw_query(struct amdxdna_dev_hdl *ndev)
+static void aie2_info_cache_update(struct amdxdna_dev_hdl *ndev)
 {
-	int ret;
+	struct amdxdna_drm_query_aie_metadata *meta = &ndev->info_cache.metadata;
+	struct amdxdna_fw_ver *fw_ver = &ndev->xdna->fw_ver;
 
-	ret = aie2_query_firmware_version(ndev, &ndev->xdna->fw_ver);
-	if (ret) {
-		XDNA_ERR(ndev->xdna, "query firmware version failed");
-		return ret;
-	}
+	write_seqcount_begin(&ndev->state_seq);
+	memset(&ndev->info_cache, 0, sizeof(ndev->info_cache));
 
-	ret = aie2_query_aie_version(ndev, &ndev->version);
-	if (ret) {
-		XDNA_ERR(ndev->xdna, "Query AIE version failed");
-		return ret;
-	}
+	meta->col_size = ndev->metadata.size;
+	meta->cols = ndev->metadata.cols;
+	meta->rows = ndev->metadata.rows;
+
+	meta->version.major = ndev->metadata.version.major;
+	meta->version.minor = ndev->metadata.version.minor;
+
+	meta->core.row_count = ndev->metadata.core.row_count;
+	meta->core.row_start = ndev->metadata.core.row_start;
+	meta->core.dma_channel_count = ndev->metadata.core.dma_channel_count;
+	meta->core.lock_count = ndev->metadata.core.lock_count;
+	meta->core.event_reg_count = ndev->metadata.core.event_reg_count;
+
+	meta->mem.row_count = ndev->metadata.mem.row_count;
+	meta->mem.row_start = ndev->metadata.mem.row_start;
+	meta->mem.dma_channel_count = ndev->metadata.mem.dma_channel_count;
+	meta->mem.lock_count = ndev->metadata.mem.lock_count;
+	meta->mem.event_reg_count = ndev->metadata.mem.event_reg_count;
+
+	meta->shim.row_count = ndev->metadata.shim.row_count;
+	meta->shim.row_start = ndev->metadata.shim.row_start;
+	meta->shim.dma_channel_count = ndev->metadata.shim.dma_channel_count;
+	meta->shim.lock_count = ndev->metadata.shim.lock_count;
+	meta->shim.event_reg_count = ndev->metadata.shim.event_reg_count;
+
+	ndev->info_cache.aie_version.major = ndev->version.major;
+	ndev->info_cache.aie_version.minor = ndev->version.minor;
+
+	ndev->info_cache.fw_version.major = fw_ver->major;
+	ndev->info_cache.fw_version.minor = fw_ver->minor;
+	ndev->info_cache.fw_version.patch = fw_ver->sub;
+	ndev->info_cache.fw_version.build = fw_ver->build;
+	write_seqcount_end(&ndev->state_seq);
+}
 
-	ret = aie2_query_aie_metadata(ndev, &ndev->metadata);
+static int aie2_mgmt_fw_query(struct amdxdna_dev_hdl *ndev)
+{
+	int ret;
+
+	ret = aie2_query_firmware_info(ndev);
 	if (ret) {
-		XDNA_ERR(ndev->xdna, "Query AIE metadata failed");
+		XDNA_ERR(ndev->xdna, "Query firmware and AIE info failed");
 		return ret;
 	}
 
+	aie2_info_cache_update(ndev);
 	return 0;
 }
 
@@ -428,6 +517,8 @@ static int aie2_hw_start(struct amdxdna_dev *xdna)
 		goto destroy_mbox;
 	}
 
+	aie2_rt_cfg_sync(ndev);
+
 	ret = aie2_pm_init(ndev);
 	if (ret) {
 		XDNA_ERR(xdna, "failed to init pm, ret %d", ret);
@@ -440,6 +531,13 @@ static int aie2_hw_start(struct amdxdna_dev *xdna)
 		goto destroy_mgmt_chann;
 	}
 
+	/* Firmware may have been reloaded, refresh what GET_INFO serves from cache */
+	ret = aie2_mgmt_fw_query(ndev);
+	if (ret) {
+		XDNA_ERR(xdna, "Query firmware failed, ret %d", ret);
+		goto destroy_mgmt_chann;
+	}
+
 	ndev->dev_status = AIE2_DEV_START;
 
 	return 0;
@@ -478,8 +576,12 @@ static int aie2_init(struct amdxdna_dev *xdna)
 		return -ENOMEM;
 
 	ndev->priv = xdna->dev_info->dev_priv;
+#ifdef AMDXDNA_DEVEL
+	hash_init(ndev->pdi_hash);
+#endif
 	ndev->xdna = xdna;
 	init_rwsem(&ndev->recover_lock);
+	seqcount_mutex_init(&ndev->state_seq, &xdna->dev_lock);
 
 	if (aie2_hwctx_limit)
 		ndev->hwctx_limit = aie2_hwctx_limit;
@@ -578,17 +680,16 @@ skip_pasid:
 	}
 	xdna->dev_handle = ndev;
 
+	ret = aie2_rt_cfg_init(ndev);
+	if (ret)
+		goto disable_sva;
+
 	ret = aie2_hw_start(xdna);
 	if (ret) {
 		XDNA_ERR(xdna, "start npu failed, ret %d", ret);
 		goto disable_sva;
 	}
 
-	ret = aie2_mgmt_fw_query(ndev);
-	if (ret) {
-		XDNA_ERR(xdna, "Query firmware failed, ret %d", ret);
-		goto stop_hw;
-	}
 	ndev->total_col = min(aie2_max_col, ndev->metadata.cols);
 
 	xrs_cfg.clk_list.num_levels = ndev->max_dpm_level + 1;
@@ -654,7 +755,10 @@ static void aie2_fini(struct amdxdna_dev *xdna)
 	aie2_event_trace_fini(ndev);
 	aie2_hw_stop(xdna);
 	aie2_error_async_events_free(ndev);
+	aie2_query_buf_fini(ndev);
 #ifdef AMDXDNA_DEVEL
+	/* All contexts are gone, so are their PDIs */
+	drm_WARN_ON(&xdna->ddev, !hash_empty(ndev->pdi_hash));
 	if (iommu_mode != AMDXDNA_IOMMU_PASID)
 		goto skip_pasid;
 #endif
@@ -722,62 +826,37 @@ static int aie2_get_aie_status(struct amdxdna_client *client,
 	return 0;
 }
 
-static int aie2_get_aie_metadata(struct amdxdna_client *client,
-				 struct amdxdna_drm_get_info *args)
+static void aie2_info_cache_read(struct amdxdna_dev_hdl *ndev, void *dst,
+				 const void *src, size_t size)
 {
-	struct amdxdna_drm_query_aie_metadata *meta;
-	struct amdxdna_dev *xdna = client->xdna;
-	struct amdxdna_dev_hdl *ndev;
-	int ret = 0;
-
-	ndev = xdna->dev_handle;
-	meta = kzalloc(sizeof(*meta), GFP_KERNEL);
-	if (!meta)
-		return -ENOMEM;
-
-	meta->col_size = ndev->metadata.size;
-	meta->cols = ndev->metadata.cols;
-	meta->rows = ndev->metadata.rows;
-
-	meta->version.major = ndev->metadata.version.major;
-	meta->version.minor = ndev->metadata.version.minor;
-
-	meta->core.row_count = ndev->metadata.core.row_count;
-	meta->core.row_start = ndev->metadata.core.row_start;
-	meta->core.dma_channel_count = ndev->metadata.core.dma_channel_count;
-	meta->core.lock_count = ndev->metadata.core.lock_count;
-	meta->core.event_reg_count = ndev->metadata.core.event_reg_count;
+	unsigned int seq;
 
-	meta->mem.row_count = ndev->metadata.mem.row_count;
-	meta->mem.row_start = ndev->metadata.mem.row_start;
-	meta->mem.dma_channel_count = ndev->metadata.mem.dma_channel_count;
-	meta->mem.lock_count = ndev->metadata.mem.lock_count;
-	meta->mem.event_reg_count = ndev->metadata.mem.event_reg_count;
+	do {
+		seq = read_seqcount_begin(&ndev->state_seq);
+		memcpy(dst, src, size);
+	} while (read_seqcount_retry(&ndev->state_seq, seq));
+}
 
-	meta->shim.row_count = ndev->metadata.shim.row_count;
-	meta->shim.row_start = ndev->metadata.shim.row_start;
-	meta->shim.dma_channel_count = ndev->metadata.shim.dma_channel_count;
-	meta->shim.lock_count = ndev->metadata.shim.lock_count;
-	meta->shim.event_reg_count = ndev->metadata.shim.event_reg_count;
+static int aie2_get_aie_metadata(struct amdxdna_client *client,
+				 struct amdxdna_drm_get_info *args)
+{
+	struct amdxdna_drm_query_aie_metadata meta;
+	struct amdxdna_dev_hdl *ndev = client->xdna->dev_handle;
 
-	if (copy_to_user(u64_to_user_ptr(args->buffer), meta, sizeof(*meta)))
-		ret = -EFAULT;
+	aie2_info_cache_read(ndev, &meta, &ndev->info_cache.metadata, sizeof(meta));
+	if (copy_to_user(u64_to_user_ptr(args->buffer), &meta, sizeof(meta)))
+		return -EFAULT;
 
-	kfree(meta);
-	return ret;
+	return 0;
 }
 
 static int aie2_get_aie_version(struct amdxdna_client *client,
 				struct amdxdna_drm_get_info *args)
 {
 	struct amdxdna_drm_query_aie_version version;
-	struct amdxdna_dev *xdna = client->xdna;
-	struct amdxdna_dev_hdl *ndev;
-
-	ndev = xdna->dev_handle;
-	version.major = ndev->version.major;
-	version.minor = ndev->version.minor;
+	struct amdxdna_dev_hdl *ndev = client->xdna->dev_handle;
 
+	aie2_info_cache_read(ndev, &version, &ndev->info_cache.aie_version, sizeof(version));
 	if (copy_to_user(u64_to_user_ptr(args->buffer), &version, sizeof(version)))
 		return -EFAULT;
 
@@ -788,13 +867,9 @@ static int aie2_get_firmware_version(struct amdxdna_client *client,
 				     struct amdxdna_drm_get_info *args)
 {
 	struct amdxdna_drm_query_firmware_version version;
-	struct amdxdna_dev *xdna = client->xdna;
-
-	version.major = xdna->fw_ver.major;
-	version.minor = xdna->fw_ver.minor;
-	version.patch = xdna->fw_ver.sub;
-	version.build = xdna->fw_ver.build;
+	struct amdxdna_dev_hdl *ndev = client->xdna->dev_handle;
 
+	aie2_info_cache_read(ndev, &version, &ndev->info_cache.fw_version, sizeof(version));
 	if (copy_to_user(u64_to_user_ptr(args->buffer), &version, sizeof(version)))
 		return -EFAULT;
 
@@ -807,9 +882,13 @@ static int aie2_get_power_mode(struct amdxdna_client *client,
 	struct amdxdna_drm_get_power_mode mode = {};
 	struct amdxdna_dev *xdna = client->xdna;
 	struct amdxdna_dev_hdl *ndev;
+	unsigned int seq;
 
 	ndev = xdna->dev_handle;
-	mode.power_mode = ndev->pw_mode;
+	do {
+		seq = read_seqcount_begin(&ndev->state_seq);
+		mode.power_mode = ndev->pw_mode;
+	} while (read_seqcount_retry(&ndev->state_seq, seq));
 
 	if (copy_to_user(u64_to_user_ptr(args->buffer), &mode, sizeof(mode)))
 		return -EFAULT;
@@ -820,27 +899,25 @@ static int aie2_get_power_mode(struct amdxdna_client *client,
 static int aie2_get_clock_metadata(struct amdxdna_client *client,
 				   struct amdxdna_drm_get_info *args)
 {
-	struct amdxdna_drm_query_clock_metadata *clock;
+	struct amdxdna_drm_query_clock_metadata clock = {};
 	struct amdxdna_dev *xdna = client->xdna;
 	struct amdxdna_dev_hdl *ndev;
-	int ret = 0;
+	unsigned int seq;
 
 	ndev = xdna->dev_handle;
-	clock = kzalloc(sizeof(*clock), GFP_KERNEL);
-	if (!clock)
-		return -ENOMEM;
-
-	snprintf(clock->mp_npu_clock.name, sizeof(clock->mp_npu_clock.name),
+	snprintf(clock.mp_npu_clock.name, sizeof(clock.mp_npu_clock.name),
 		 "MP-NPU Clock");
-	clock->mp_npu_clock.freq_mhz = ndev->npuclk_freq;
-	snprintf(clock->h_clock.name, sizeof(clock->h_clock.name), "H Clock");
-	clock->h_clock.freq_mhz = ndev->hclk_freq;
-
-	if (copy_to_user(u64_to_user_ptr(args->buffer), clock, sizeof(*clock)))
-		ret = -EFAULT;
+	snprintf(clock.h_clock.name, sizeof(clock.h_clock.name), "H Clock");
+	do {
+		seq = read_seqcount_begin(&ndev->state_seq);
+		clock.mp_npu_clock.freq_mhz = ndev->npuclk_freq;
+		clock.h_clock.freq_mhz = ndev->hclk_freq;
+	} while (read_seqcount_retry(&ndev->state_seq, seq));
+
+	if (copy_to_user(u64_to_user_ptr(args->buffer), &clock, sizeof(clock)))
+		return -EFAULT;
 
-	kfree(clock);
-	return ret;
+	return 0;
 }
 
 static int aie2_get_sensors(struct amdxdna_client *client,
@@ -879,16 +956,17 @@ static int aie2_get_ctx_status(struct amdxdna_client *client,
 	u32 req_bytes = 0;
 	u32 hw_i = 0;
 	int ret = 0;
+	int cidx;
 	int idx;
 
-	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
-
 	tmp = kzalloc(sizeof(*tmp), GFP_KERNEL);
 	if (!tmp)
 		return -ENOMEM;
 
 	buf = u64_to_user_ptr(args->buffer);
-	list_for_each_entry(tmp_client, &xdna->client_list, node) {
+	cidx = srcu_read_lock(&xdna->client_srcu);
+	list_for_each_entry_srcu(tmp_client, &xdna->client_list, node,
+				 srcu_read_lock_held(&xdna->client_srcu)) {
 		idx = srcu_read_lock(&tmp_client->ctx_srcu);
 		amdxdna_for_each_ctx(tmp_client, ctx_id, ctx) {
 			req_bytes += sizeof(*tmp);
@@ -907,18 +985,20 @@ static int aie2_get_ctx_status(struct amdxdna_client *client,
 			tmp->command_completions = ctx->completed;
 			tmp->migrations = 0;
 			tmp->preemptions = 0;
-			tmp->errors = 0;
+			tmp->errors = ctx->errors;
 			tmp->priority = ctx->qos.priority;
 
 			if (copy_to_user(&buf[hw_i], tmp, sizeof(*tmp))) {
 				ret = -EFAULT;
 				srcu_read_unlock(&tmp_client->ctx_srcu, idx);
+				srcu_read_unlock(&xdna->client_srcu, cidx);
 				goto out;
 			}
 			hw_i++;
 		}
 		srcu_read_unlock(&tmp_client->ctx_srcu, idx);
 	}
+	srcu_read_unlock(&xdna->client_srcu, cidx);
 
 	if (overflow) {
 		XDNA_ERR(xdna, "Invalid buffer size. Given: %u Need: %u.",
@@ -956,11 +1036,11 @@ static int aie2_get_telemetry(struct amdxdna_client *client,
 
 	ndev = xdna->dev_handle;
 	aligned_sz = PAGE_ALIGN(args->buffer_size);
-	buff = dma_alloc_noncoherent(xdna->ddev.dev, aligned_sz, &dma_addr,
-				     DMA_FROM_DEVICE, GFP_KERNEL);
+	buff = aie2_query_buf_get(ndev, aligned_sz, &dma_addr);
 	if (!buff)
 		return -ENOMEM;
 
+	/* Buffer is reused, don't return what the previous query left */
 	memset(buff, 0, aligned_sz);
 	drm_clflush_virt_range(buff, aligned_sz); /* device can access */
 	/* The first two words of the buffer is reserved for major and minor */
@@ -973,12 +1053,12 @@ static int aie2_get_telemetry(struct amdxdna_client *client,
 	((u32 *)buff)[0] = ver.major;
 	((u32 *)buff)[1] = ver.minor;
 	print_hex_dump_debug("telemetry: ", DUMP_PREFIX_OFFSET, 16, 4, buff,
-			     aligned_sz, false);
+			     min_t(size_t, aligned_sz, SZ_256), false);
 	if (copy_to_user(u64_to_user_ptr(args->buffer), buff, args->buffer_size))
 		ret = -EFAULT;
 
 free_buf:
-	dma_free_noncoherent(xdna->ddev.dev, aligned_sz, buff, dma_addr, DMA_FROM_DEVICE);
+	aie2_query_buf_put(ndev, buff, aligned_sz, dma_addr);
 	return ret;
 }
 
@@ -988,9 +1068,13 @@ static int aie2_get_force_preempt_state(struct amdxdna_client *client,
 	struct amdxdna_drm_get_force_preempt_state force = {};
 	struct amdxdna_dev *xdna = client->xdna;
 	struct amdxdna_dev_hdl *ndev;
+	unsigned int seq;
 
 	ndev = xdna->dev_handle;
-	force.state = ndev->force_preempt_enabled;
+	do {
+		seq = read_seqcount_begin(&ndev->state_seq);
+		force.state = ndev->force_preempt_enabled;
+	} while (read_seqcount_retry(&ndev->state_seq, seq));
 
 	if (copy_to_user(u64_to_user_ptr(args->buffer), &force, sizeof(force)))
 		return -EFAULT;
@@ -998,6 +1082,43 @@ static int aie2_get_force_preempt_state(struct amdxdna_client *client,
 	return 0;
 }
 
+/* Queries that talk to firmware or use the shared query buffer */
+static int aie2_get_info_locked(struct amdxdna_client *client,
+				struct amdxdna_drm_get_info *args)
+{
+	struct amdxdna_dev *xdna = client->xdna;
+	int ret;
+
+	mutex_lock(&xdna->dev_lock);
+	switch (args->param) {
+	case DRM_AMDXDNA_QUERY_AIE_STATUS:
+		ret = aie2_get_aie_status(client, args);
+		break;
+#ifdef AMDXDNA_AIE2_PRIV
+	case DRM_AMDXDNA_READ_AIE_MEM:
+		ret = aie2_read_aie_mem(client, args);
+		break;
+	case DRM_AMDXDNA_READ_AIE_REG:
+		ret = aie2_read_aie_reg(client, args);
+		break;
+#endif
+	case DRM_AMDXDNA_QUERY_TELEMETRY:
+		ret = aie2_get_telemetry(client, args);
+		break;
+	default:
+		XDNA_ERR(xdna, "Not supported request parameter %u", args->param);
+		ret = -EOPNOTSUPP;
+	}
+	mutex_unlock(&xdna->dev_lock);
+
+	return ret;
+}
+
+/*
+ * Metadata and versions are served from info_cache. The cache, power mode,
+ * clocks and preemption state are read under state_seq and the context
+ * list under SRCU, so polling these does not contend with the data path.
+ */
 static int aie2_get_info(struct amdxdna_client *client, struct amdxdna_drm_get_info *args)
 {
 	struct amdxdna_dev *xdna = client->xdna;
@@ -1007,9 +1128,6 @@ static int aie2_get_info(struct amdxdna_client *client, struct amdxdna_drm_get_i
 		return -ENODEV;
 
 	switch (args->param) {
-	case DRM_AMDXDNA_QUERY_AIE_STATUS:
-		ret = aie2_get_aie_status(client, args);
-		break;
 	case DRM_AMDXDNA_QUERY_AIE_METADATA:
 		ret = aie2_get_aie_metadata(client, args);
 		break;
@@ -1025,29 +1143,20 @@ static int aie2_get_info(struct amdxdna_client *client, struct amdxdna_drm_get_i
 	case DRM_AMDXDNA_QUERY_HW_CONTEXTS:
 		ret = aie2_get_ctx_status(client, args);
 		break;
-#ifdef AMDXDNA_AIE2_PRIV
-	case DRM_AMDXDNA_READ_AIE_MEM:
-		ret = aie2_read_aie_mem(client, args);
-		break;
-	case DRM_AMDXDNA_READ_AIE_REG:
-		ret = aie2_read_aie_reg(client, args);
-		break;
-#endif
 	case DRM_AMDXDNA_QUERY_FIRMWARE_VERSION:
 		ret = aie2_get_firmware_version(client, args);
 		break;
 	case DRM_AMDXDNA_GET_POWER_MODE:
 		ret = aie2_get_power_mode(client, args);
 		break;
-	case DRM_AMDXDNA_QUERY_TELEMETRY:
-		ret = aie2_get_telemetry(client, args);
-		break;
 	case DRM_AMDXDNA_GET_FORCE_PREEMPT_STATE:
 		ret = aie2_get_force_preempt_state(client, args);
 		break;
+	case DRM_AMDXDNA_QUERY_CLIENT_USAGE:
+		ret = amdxdna_get_client_usage(xdna, args);
+		break;
 	default:
-		XDNA_ERR(xdna, "Not supported request parameter %u", args->param);
-		ret = -EOPNOTSUPP;
+		ret = aie2_get_info_locked(client, args);
 	}
 	XDNA_DBG(xdna, "Got param %d", args->param);
 
@@ -1098,7 +1207,9 @@ static int aie2_set_force_preempt_state(struct amdxdna_client *client,
 		return -EFAULT;
 	}
 
+	write_seqcount_begin(&xdna->dev_handle->state_seq);
 	xdna->dev_handle->force_preempt_enabled = force.state;
+	write_seqcount_end(&xdna->dev_handle->state_seq);
 
 	XDNA_WARN(xdna, "Force preemption %s", force.state ? "enabled" : "disabled");
 
@@ -1120,6 +1231,9 @@ static int aie2_set_state(struct amdxdna_client *client, struct amdxdna_drm_set_
 	case DRM_AMDXDNA_SET_FORCE_PREEMPT:
 		ret = aie2_set_force_preempt_state(client, args);
 		break;
+	case DRM_AMDXDNA_SET_CLIENT_BUDGET:
+		ret = amdxdna_set_client_budget(xdna, args);
+		break;
 #ifdef AMDXDNA_AIE2_PRIV
 	case DRM_AMDXDNA_WRITE_AIE_MEM:
 		ret = aie2_write_aie_mem(client, args);
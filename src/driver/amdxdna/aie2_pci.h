@@ -7,10 +7,12 @@
 #define _AIE2_PCI_H_
 
 #include <linux/device.h>
+#include <linux/hashtable.h>
 #include <linux/iopoll.h>
 #include <linux/wait.h>
 #include <linux/io.h>
 #include <linux/semaphore.h>
+#include <linux/seqlock.h>
 #include <drm/gpu_scheduler.h>
 
 #include "drm_local/amdxdna_accel.h"
@@ -151,6 +153,16 @@ struct aie_metadata {
 	struct aie_tile_metadata shim;
 };
 
+/*
+ * GET_INFO replies that only change when firmware restarts. Rebuilt from
+ * the firmware and AIE info queried at every firmware start.
+ */
+struct aie2_info_cache {
+	struct amdxdna_drm_query_aie_metadata		metadata;
+	struct amdxdna_drm_query_aie_version		aie_version;
+	struct amdxdna_drm_query_firmware_version	fw_version;
+};
+
 enum rt_config_category {
 	AIE2_RT_CFG_INIT,
 	AIE2_RT_CFG_CLK_GATING,
@@ -164,15 +176,34 @@ struct rt_config {
 	u32	category;
 };
 
+#define AIE2_MAX_RT_CFGS	16
+
+/*
+ * Runtime config entry kept by the driver. fw_value is what firmware holds,
+ * only meaningful when fw_known. Unknown entries are always sent.
+ */
+struct aie2_rt_cfg {
+	const struct rt_config	*cfg;
+	u64			fw_value;
+	bool			fw_known;
+};
+
 struct dpm_clk_freq {
 	u32	npuclk;
 	u32	hclk;
 };
 
 #ifdef AMDXDNA_DEVEL
-struct ctx_pdi {
+/*
+ * PDI registered to firmware, shared by all contexts of the device loading
+ * the same PDI content. Protected by xdna->dev_lock.
+ */
+struct aie2_pdi {
+	struct hlist_node	node;
+	u32			refcnt;
+	u64			hash;
 	int			id;
-	int			registered;
+	bool			registered;
 	size_t			size;
 	void			*addr;
 	dma_addr_t		dma_addr;
@@ -188,10 +219,16 @@ struct ctx_pdi {
 struct amdxdna_ctx_priv {
 	struct amdxdna_gem_obj		*heap;
 #ifdef AMDXDNA_DEVEL
-	struct ctx_pdi			*pdi_infos;
+	struct aie2_pdi			**pdis;
 #endif
 
 	struct amdxdna_gem_obj		*cmd_buf[CTX_MAX_CMDS];
+	/* User visible copy of ctx->completed */
+	struct amdxdna_gem_obj		*completed_bo;
+	/* User read-only struct amdxdna_ctx_status */
+	struct amdxdna_gem_obj		*status_bo;
+	spinlock_t			status_lock; /* serialize status_bo writers */
+	u32				status_seq;
 
 	struct mutex			io_lock; /* protect seq and cmd order */
 #ifdef AMDXDNA_DEVEL
@@ -253,6 +290,13 @@ struct amdxdna_dev_hdl {
 	u32				npuclk_freq;
 	u32				hclk_freq;
 	bool				force_preempt_enabled;
+	/* Writers hold dev_lock, GET_INFO reads pw_mode, clocks, preempt state and info_cache lock-free */
+	seqcount_mutex_t		state_seq;
+	struct aie2_info_cache		info_cache;
+
+	/* Runtime configs of rt_config table, protected by dev_lock */
+	struct aie2_rt_cfg		*rt_cfg;
+	u32				rt_cfg_cnt;
 
 	/* Mailbox and the management channel */
 	struct mailbox			*mbox;
@@ -263,6 +307,15 @@ struct amdxdna_dev_hdl {
 	u32				dev_status;
 	u32				hwctx_cnt;
 	u32				hwctx_limit;
+
+	/* Reused by telemetry and status queries, protected by dev_lock */
+	void				*query_buf;
+	dma_addr_t			query_buf_dma;
+	size_t				query_buf_size;
+#ifdef AMDXDNA_DEVEL
+	/* Registered PDIs by content hash, see struct aie2_pdi */
+	DECLARE_HASHTABLE(pdi_hash, 6);
+#endif
 };
 
 #define DEFINE_BAR_OFFSET(reg_name, bar, reg_addr) \
@@ -371,14 +424,18 @@ void aie2_assign_event_trace_state(struct amdxdna_dev_hdl *ndev, bool state);
 /* aie2_message.c */
 int aie2_suspend_fw(struct amdxdna_dev_hdl *ndev);
 int aie2_resume_fw(struct amdxdna_dev_hdl *ndev);
-int aie2_set_runtime_cfg(struct amdxdna_dev_hdl *ndev, u32 type, u64 value);
-int aie2_get_runtime_cfg(struct amdxdna_dev_hdl *ndev, u32 type, u64 *value);
+int aie2_set_runtime_cfgs(struct amdxdna_dev_hdl *ndev, struct aie2_rt_cfg **cfgs,
+			  const u64 *values, u32 cnt);
+int aie2_get_runtime_cfgs(struct amdxdna_dev_hdl *ndev, struct aie2_rt_cfg **cfgs, u32 cnt);
 int aie2_check_protocol_version(struct amdxdna_dev_hdl *ndev);
 int aie2_assign_mgmt_pasid(struct amdxdna_dev_hdl *ndev, u16 pasid);
 int aie2_query_telemetry(struct amdxdna_dev_hdl *ndev, u32 type, dma_addr_t addr,
 			 u32 size, struct aie_version *version);
-int aie2_query_aie_version(struct amdxdna_dev_hdl *ndev, struct aie_version *version);
-int aie2_query_aie_metadata(struct amdxdna_dev_hdl *ndev, struct aie_metadata *metadata);
+int aie2_query_firmware_info(struct amdxdna_dev_hdl *ndev);
+void *aie2_query_buf_get(struct amdxdna_dev_hdl *ndev, size_t size, dma_addr_t *dma_addr);
+void aie2_query_buf_put(struct amdxdna_dev_hdl *ndev, void *buf, size_t size,
+			dma_addr_t dma_addr);
+void aie2_query_buf_fini(struct amdxdna_dev_hdl *ndev);
 int aie2_query_firmware_version(struct amdxdna_dev_hdl *ndev,
 				struct amdxdna_fw_ver *fw_ver);
 int aie2_start_event_trace(struct amdxdna_dev_hdl *ndev, dma_addr_t addr, u32 size);
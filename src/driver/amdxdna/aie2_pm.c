@@ -49,7 +49,9 @@ int aie2_pm_init(struct amdxdna_dev_hdl *ndev)
 	if (ret)
 		return ret;
 
+	write_seqcount_begin(&ndev->state_seq);
 	ndev->pw_mode = POWER_MODE_DEFAULT;
+	write_seqcount_end(&ndev->state_seq);
 	ndev->dft_dpm_level = ndev->max_dpm_level;
 
 	return 0;
@@ -104,7 +106,9 @@ int aie2_pm_set_mode(struct amdxdna_dev_hdl *ndev, int target)
 	if (ret)
 		return ret;
 
+	write_seqcount_begin(&ndev->state_seq);
 	ndev->pw_mode = target;
+	write_seqcount_end(&ndev->state_seq);
 
 	return 0;
 }
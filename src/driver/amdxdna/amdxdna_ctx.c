@@ -16,6 +16,12 @@
 
 #define MAX_CTX_ID		255
 #define MAX_ARG_COUNT		4095
+/* Arg BO handles snapshotted from a submit area on stack up to this count */
+#define XDNA_AREA_INLINE_ARGS	16
+/* Jobs with up to this many argument BOs are recycled through the job cache */
+#define XDNA_JOB_CACHE_BOS	16
+
+static struct kmem_cache *amdxdna_job_cache;
 
 struct amdxdna_fence {
 	struct dma_fence	base;
@@ -70,6 +76,8 @@ static void amdxdna_ctx_destroy_rcu(struct amdxdna_ctx *ctx, struct srcu_struct
 	xdna->ctx_cnt--;
 	mutex_unlock(&xdna->dev_lock);
 
+	if (ctx->submit_area)
+		amdxdna_gem_put_obj(ctx->submit_area);
 	kfree(ctx->name);
 	kfree(ctx);
 }
@@ -156,6 +164,8 @@ int amdxdna_drm_create_ctx_ioctl(struct drm_device *dev, void *data, struct drm_
 	args->handle = ctx->id;
 	args->syncobj_handle = ctx->syncobj_hdl;
 	args->umq_doorbell = ctx->doorbell_offset;
+	args->completed_addr = ctx->completed_addr;
+	args->status_offset = ctx->status_offset;
 	xdna->ctx_cnt++;
 	mutex_unlock(&xdna->dev_lock);
 
@@ -210,6 +220,37 @@ out:
 	return ret;
 }
 
+static int amdxdna_ctx_assign_submit_area(struct amdxdna_ctx *ctx, u32 bo_hdl)
+{
+	struct amdxdna_client *client = ctx->client;
+	struct amdxdna_gem_obj *abo;
+
+	abo = amdxdna_gem_get_obj(client, bo_hdl, AMDXDNA_BO_DEV);
+	if (!abo) {
+		XDNA_ERR(client->xdna, "Get submit area bo %d failed", bo_hdl);
+		return -EINVAL;
+	}
+
+	if (!abo->mem.kva || abo->mem.size <= sizeof(struct amdxdna_submit_area_hdr)) {
+		XDNA_ERR(client->xdna, "Invalid submit area bo %d", bo_hdl);
+		goto put_obj;
+	}
+
+	/* Paired with smp_load_acquire() in amdxdna_submit_area_get() */
+	if (cmpxchg_release(&ctx->submit_area, NULL, abo)) {
+		XDNA_ERR(client->xdna, "Ctx %s already has a submit area", ctx->name);
+		amdxdna_gem_put_obj(abo);
+		return -EBUSY;
+	}
+
+	XDNA_DBG(client->xdna, "Ctx %s submit area bo %d", ctx->name, bo_hdl);
+	return 0;
+
+put_obj:
+	amdxdna_gem_put_obj(abo);
+	return -EINVAL;
+}
+
 int amdxdna_drm_config_ctx_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
 {
 	struct amdxdna_client *client = filp->driver_priv;
@@ -247,6 +288,7 @@ int amdxdna_drm_config_ctx_ioctl(struct drm_device *dev, void *data, struct drm_
 		break;
 	case DRM_AMDXDNA_CTX_ASSIGN_DBG_BUF:
 	case DRM_AMDXDNA_CTX_REMOVE_DBG_BUF:
+	case DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA:
 		/* For those types that param_val is a value */
 		buf = NULL;
 		buf_size = 0;
@@ -264,7 +306,10 @@ int amdxdna_drm_config_ctx_ioctl(struct drm_device *dev, void *data, struct drm_
 		goto unlock_srcu;
 	}
 
-	ret = xdna->dev_info->ops->ctx_config(ctx, args->param_type, val, buf, buf_size);
+	if (args->param_type == DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA)
+		ret = amdxdna_ctx_assign_submit_area(ctx, val);
+	else
+		ret = xdna->dev_info->ops->ctx_config(ctx, args->param_type, val, buf, buf_size);
 
 unlock_srcu:
 	srcu_read_unlock(&client->ctx_srcu, idx);
@@ -272,11 +317,49 @@ unlock_srcu:
 	return ret;
 }
 
+static void amdxdna_bo_list_release(struct kref *ref)
+{
+	struct amdxdna_bo_list *list;
+	int i;
+
+	list = container_of(ref, struct amdxdna_bo_list, refcnt);
+	for (i = 0; i < list->bo_cnt; i++) {
+		if (!list->bos[i])
+			break;
+		drm_gem_object_put(list->bos[i]);
+	}
+	kfree(list);
+}
+
+static void amdxdna_bo_list_put(struct amdxdna_bo_list *list)
+{
+	kref_put(&list->refcnt, amdxdna_bo_list_release);
+}
+
+static struct amdxdna_bo_list *
+amdxdna_bo_list_get(struct amdxdna_client *client, u32 hdl)
+{
+	struct amdxdna_bo_list *list;
+
+	xa_lock(&client->bo_list_xa);
+	list = xa_load(&client->bo_list_xa, hdl);
+	if (list)
+		kref_get(&list->refcnt);
+	xa_unlock(&client->bo_list_xa);
+
+	return list;
+}
+
 static void
 amdxdna_arg_bos_put(struct amdxdna_sched_job *job)
 {
 	int i;
 
+	if (job->bo_list) {
+		amdxdna_bo_list_put(job->bo_list);
+		return;
+	}
+
 	for (i = 0; i < job->bo_cnt; i++) {
 		if (!job->bos[i].obj)
 			break;
@@ -284,51 +367,211 @@ amdxdna_arg_bos_put(struct amdxdna_sched_job *job)
 	}
 }
 
+/*
+ * Lookup argument BO and make sure it is pinned. The pin is dropped when the
+ * BO is freed, so it is only taken the first time the BO is submitted.
+ */
+static struct drm_gem_object *
+amdxdna_arg_bo_get(struct amdxdna_client *client, u32 bo_hdl)
+{
+	struct drm_gem_object *gobj;
+	struct amdxdna_gem_obj *abo;
+	int ret;
+
+	gobj = drm_gem_object_lookup(client->filp, bo_hdl);
+	if (!gobj)
+		return ERR_PTR(-ENOENT);
+	abo = to_xdna_obj(gobj);
+
+	mutex_lock(&abo->lock);
+	if (abo->flags & BO_SUBMIT_PINNED)
+		goto out;
+
+	ret = amdxdna_gem_pin_nolock(abo);
+	if (ret) {
+		mutex_unlock(&abo->lock);
+		drm_gem_object_put(gobj);
+		return ERR_PTR(ret);
+	}
+	abo->flags |= BO_SUBMIT_PINNED;
+out:
+	mutex_unlock(&abo->lock);
+	return gobj;
+}
+
 static int
 amdxdna_arg_bos_lookup(struct amdxdna_client *client,
 		       struct amdxdna_sched_job *job,
 		       u32 *bo_hdls, u32 bo_cnt)
 {
 	struct drm_gem_object *gobj;
-	int i, ret;
+	int i;
 
 	job->bo_cnt = bo_cnt;
 	for (i = 0; i < job->bo_cnt; i++) {
-		struct amdxdna_gem_obj *abo;
+		gobj = amdxdna_arg_bo_get(client, bo_hdls[i]);
+		if (IS_ERR(gobj))
+			return PTR_ERR(gobj);
 
-		gobj = drm_gem_object_lookup(client->filp, bo_hdls[i]);
-		if (!gobj) {
-			ret = -ENOENT;
-			goto put_arg_bos;
-		}
-		abo = to_xdna_obj(gobj);
+		job->bos[i].obj = gobj;
+	}
 
-		mutex_lock(&abo->lock);
-		if (abo->flags & BO_SUBMIT_PINNED) {
-			mutex_unlock(&abo->lock);
-			job->bos[i].obj = gobj;
-			continue;
-		}
+	return 0;
+}
 
-		ret = amdxdna_gem_pin_nolock(abo);
-		if (ret) {
-			mutex_unlock(&abo->lock);
-			drm_gem_object_put(gobj);
-			goto put_arg_bos;
+static void
+amdxdna_bo_list_use(struct amdxdna_sched_job *job, struct amdxdna_bo_list *list)
+{
+	int i;
+
+	job->bo_list = list;
+	job->bo_cnt = list->bo_cnt;
+	for (i = 0; i < job->bo_cnt; i++)
+		job->bos[i].obj = list->bos[i];
+}
+
+/*
+ * Called from postclose(), all jobs are done or hold their own reference of
+ * the BO list.
+ */
+void amdxdna_bo_list_remove_all(struct amdxdna_client *client)
+{
+	struct amdxdna_bo_list *list;
+	unsigned long hdl;
+
+	xa_for_each(&client->bo_list_xa, hdl, list) {
+		xa_erase(&client->bo_list_xa, hdl);
+		amdxdna_bo_list_put(list);
+	}
+}
+
+int amdxdna_drm_create_bo_list_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
+{
+	struct amdxdna_client *client = filp->driver_priv;
+	struct amdxdna_drm_create_bo_list *args = data;
+	struct amdxdna_dev *xdna = to_xdna_dev(dev);
+	struct amdxdna_bo_list *list;
+	struct drm_gem_object *gobj;
+	u32 *bo_hdls;
+	int ret, i;
+
+	if (args->ext || args->ext_flags)
+		return -EINVAL;
+
+	if (!args->count || args->count > MAX_ARG_COUNT) {
+		XDNA_ERR(xdna, "Invalid BO list count %d", args->count);
+		return -EINVAL;
+	}
+
+	bo_hdls = kcalloc(args->count, sizeof(u32), GFP_KERNEL);
+	if (!bo_hdls)
+		return -ENOMEM;
+
+	if (copy_from_user(bo_hdls, u64_to_user_ptr(args->handles),
+			   args->count * sizeof(u32))) {
+		ret = -EFAULT;
+		goto free_hdls;
+	}
+
+	list = kzalloc(struct_size(list, bos, args->count), GFP_KERNEL);
+	if (!list) {
+		ret = -ENOMEM;
+		goto free_hdls;
+	}
+	kref_init(&list->refcnt);
+	list->bo_cnt = args->count;
+
+	for (i = 0; i < list->bo_cnt; i++) {
+		gobj = amdxdna_arg_bo_get(client, bo_hdls[i]);
+		if (IS_ERR(gobj)) {
+			ret = PTR_ERR(gobj);
+			XDNA_ERR(xdna, "Get BO %d failed, ret %d", bo_hdls[i], ret);
+			goto put_list;
 		}
-		abo->flags |= BO_SUBMIT_PINNED;
-		mutex_unlock(&abo->lock);
+		list->bos[i] = gobj;
+	}
 
-		job->bos[i].obj = gobj;
+	ret = xa_alloc(&client->bo_list_xa, &args->handle, list,
+		       xa_limit_32b, GFP_KERNEL);
+	if (ret) {
+		XDNA_ERR(xdna, "Allocate BO list ID failed, ret %d", ret);
+		goto put_list;
 	}
 
+	XDNA_DBG(xdna, "PID %d created BO list %d with %d BOs",
+		 client->pid, args->handle, list->bo_cnt);
+	kfree(bo_hdls);
 	return 0;
 
-put_arg_bos:
-	amdxdna_arg_bos_put(job);
+put_list:
+	amdxdna_bo_list_put(list);
+free_hdls:
+	kfree(bo_hdls);
 	return ret;
 }
 
+int amdxdna_drm_destroy_bo_list_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
+{
+	struct amdxdna_client *client = filp->driver_priv;
+	struct amdxdna_drm_destroy_bo_list *args = data;
+	struct amdxdna_bo_list *list;
+
+	list = xa_erase(&client->bo_list_xa, args->handle);
+	if (!list) {
+		XDNA_DBG(client->xdna, "PID %d BO list %d not exist",
+			 client->pid, args->handle);
+		return -EINVAL;
+	}
+
+	amdxdna_bo_list_put(list);
+	return 0;
+}
+
+/*
+ * A job is allocated for every command. Recycle it through a dedicated slab
+ * cache instead of going through the generic kmalloc caches. Fences stay on
+ * kmalloc, they can be held by other drivers and processes long after the
+ * module is gone, which a module owned cache can't outlive.
+ */
+int amdxdna_ctx_caches_init(void)
+{
+	amdxdna_job_cache = kmem_cache_create("amdxdna_job",
+					      sizeof(struct amdxdna_sched_job) +
+					      XDNA_JOB_CACHE_BOS * sizeof(struct amdxdna_job_bo),
+					      0, SLAB_HWCACHE_ALIGN, NULL);
+	if (!amdxdna_job_cache)
+		return -ENOMEM;
+
+	return 0;
+}
+
+/* All jobs are released by context teardown before the driver unbinds */
+void amdxdna_ctx_caches_fini(void)
+{
+	kmem_cache_destroy(amdxdna_job_cache);
+}
+
+struct amdxdna_sched_job *amdxdna_sched_job_alloc(u32 bo_cnt)
+{
+	struct amdxdna_sched_job *job;
+
+	if (bo_cnt > XDNA_JOB_CACHE_BOS)
+		return kzalloc(struct_size(job, bos, bo_cnt), GFP_KERNEL);
+
+	job = kmem_cache_zalloc(amdxdna_job_cache, GFP_KERNEL);
+	if (job)
+		job->cached = true;
+	return job;
+}
+
+void amdxdna_sched_job_free(struct amdxdna_sched_job *job)
+{
+	if (job->cached)
+		kmem_cache_free(amdxdna_job_cache, job);
+	else
+		kfree(job);
+}
+
 void amdxdna_sched_job_cleanup(struct amdxdna_sched_job *job)
 {
 	trace_amdxdna_debug_point(job->ctx->name, job->seq, "job release");
@@ -339,6 +582,7 @@ void amdxdna_sched_job_cleanup(struct amdxdna_sched_job *job)
 int amdxdna_lock_objects(struct amdxdna_sched_job *job, struct ww_acquire_ctx *ctx)
 {
 	struct amdxdna_dev *xdna = job->ctx->client->xdna;
+	struct dma_resv *client_resv = NULL;
 	int contended = -1, i, ret;
 
 	ww_acquire_init(ctx, &reservation_ww_class);
@@ -351,19 +595,28 @@ retry:
 			return ret;
 		}
 		job->bos[contended].locked = true;
+		if (to_xdna_obj(job->bos[contended].obj)->flags & BO_CLIENT_RESV)
+			client_resv = job->bos[contended].obj->resv;
 	}
 
 	for (i = 0; i < job->bo_cnt; i++) {
 		if (job->bos[i].locked)
 			continue;
 
+		/* All BO_CLIENT_RESV BOs share one resv, lock it for the first one */
+		if (job->bos[i].obj->resv == client_resv)
+			continue;
+
 		ret = dma_resv_lock_interruptible(job->bos[i].obj->resv, ctx);
+		/* The same BO passed more than once */
 		if (ret == -EALREADY)
 			continue;
 
 		if (ret) {
 			int j;
 
+			client_resv = NULL;
+
 			for (j = i - 1; j >= 0; j--) {
 				if (job->bos[j].locked) {
 					dma_resv_unlock(job->bos[j].obj->resv);
@@ -389,6 +642,8 @@ retry:
 			return ret;
 		}
 		job->bos[i].locked = true;
+		if (to_xdna_obj(job->bos[i].obj)->flags & BO_CLIENT_RESV)
+			client_resv = job->bos[i].obj->resv;
 	}
 
 	ww_acquire_done(ctx);
@@ -413,36 +668,54 @@ void amdxdna_unlock_objects(struct amdxdna_sched_job *job, struct ww_acquire_ctx
 
 int amdxdna_cmd_submit(struct amdxdna_client *client, u32 opcode,
 		       u32 cmd_bo_hdl, u32 *arg_bo_hdls, u32 arg_bo_cnt,
+		       u32 bo_list_hdl,
 		       u32 *syncobj_hdls, u64 *syncobj_points, u32 syncobj_cnt,
 		       u32 ctx_hdl, u64 *seq)
 {
 	struct amdxdna_dev *xdna = client->xdna;
+	struct amdxdna_bo_list *bo_list = NULL;
 	struct amdxdna_sched_job *job;
 	struct amdxdna_ctx *ctx;
 	int ret, idx;
 
+	if (bo_list_hdl != AMDXDNA_INVALID_BO_LIST_HANDLE) {
+		bo_list = amdxdna_bo_list_get(client, bo_list_hdl);
+		if (!bo_list) {
+			XDNA_ERR(xdna, "Failed to get BO list %d", bo_list_hdl);
+			return -EINVAL;
+		}
+		arg_bo_cnt = bo_list->bo_cnt;
+	}
+
 	XDNA_DBG(xdna, "Command BO hdl %d, Arg BO count %d", cmd_bo_hdl, arg_bo_cnt);
-	job = kzalloc(struct_size(job, bos, arg_bo_cnt), GFP_KERNEL);
-	if (!job)
+	job = amdxdna_sched_job_alloc(arg_bo_cnt);
+	if (!job) {
+		if (bo_list)
+			amdxdna_bo_list_put(bo_list);
 		return -ENOMEM;
+	}
+
+	/* From now on, the BO list reference is owned by job */
+	if (bo_list)
+		amdxdna_bo_list_use(job, bo_list);
 
 	if (cmd_bo_hdl != AMDXDNA_INVALID_BO_HANDLE) {
 		job->cmd_bo = amdxdna_gem_get_obj(client, cmd_bo_hdl, AMDXDNA_BO_CMD);
 		if (!job->cmd_bo) {
 			XDNA_ERR(xdna, "Failed to get cmd bo from %d", cmd_bo_hdl);
 			ret = -EINVAL;
-			goto free_job;
+			goto put_arg_bos;
 		}
 	} else {
 		job->cmd_bo = NULL;
 		drm_WARN_ON(&xdna->ddev, opcode == OP_USER);
 	}
 
-	if (arg_bo_hdls) {
+	if (!bo_list && arg_bo_hdls) {
 		ret = amdxdna_arg_bos_lookup(client, job, arg_bo_hdls, arg_bo_cnt);
 		if (ret) {
 			XDNA_ERR(xdna, "Argument BOs lookup failed, ret %d", ret);
-			goto cmd_put;
+			goto put_arg_bos;
 		}
 	}
 
@@ -489,14 +762,308 @@ put_fence:
 	dma_fence_put(job->fence);
 unlock_srcu:
 	srcu_read_unlock(&client->ctx_srcu, idx);
+put_arg_bos:
 	amdxdna_arg_bos_put(job);
-cmd_put:
 	amdxdna_gem_put_obj(job->cmd_bo);
-free_job:
-	kfree(job);
+	amdxdna_sched_job_free(job);
 	return ret;
 }
 
+/*
+ * Get the submission area of the context. The arrays in it are only used if
+ * user has published them under generation gen.
+ */
+static struct amdxdna_gem_obj *
+amdxdna_submit_area_get(struct amdxdna_client *client, u32 ctx_hdl, u64 gen)
+{
+	struct amdxdna_submit_area_hdr *hdr;
+	struct amdxdna_gem_obj *area = NULL;
+	struct amdxdna_ctx *ctx;
+	int idx;
+
+	idx = srcu_read_lock(&client->ctx_srcu);
+	ctx = xa_load(&client->ctx_xa, ctx_hdl);
+	if (ctx)
+		area = smp_load_acquire(&ctx->submit_area);
+	if (area)
+		drm_gem_object_get(to_gobj(area));
+	srcu_read_unlock(&client->ctx_srcu, idx);
+
+	if (!area) {
+		XDNA_ERR(client->xdna, "No submit area for ctx %d", ctx_hdl);
+		return ERR_PTR(-EINVAL);
+	}
+
+	hdr = area->mem.kva;
+	if (READ_ONCE(hdr->generation) != gen) {
+		XDNA_DBG(client->xdna, "Submit area generation %lld, expect %lld",
+			 READ_ONCE(hdr->generation), gen);
+		amdxdna_gem_put_obj(area);
+		return ERR_PTR(-ESTALE);
+	}
+
+	return area;
+}
+
+/* Returns the array of cnt elements at offset in area, or NULL if out of bounds */
+static void *amdxdna_submit_area_ptr(struct amdxdna_gem_obj *area, u64 offset,
+				     u32 cnt, size_t esize)
+{
+	size_t size = area->mem.size;
+
+	if (offset < sizeof(struct amdxdna_submit_area_hdr) || offset >= size ||
+	    !IS_ALIGNED(offset, esize) || (size_t)cnt * esize > size - offset)
+		return NULL;
+
+	return area->mem.kva + offset;
+}
+
+/*
+ * Snapshot the arg BO handle array in the submission area. User space can
+ * still write the area, so every handle must be fetched exactly once. Small
+ * arrays go to buf, larger ones to an allocation which the caller frees if it
+ * is not buf.
+ */
+static u32 *amdxdna_arg_bos_in_area(struct amdxdna_dev *xdna, struct amdxdna_gem_obj *area,
+				    u64 offset, u32 cnt, u32 *buf, u32 buf_cnt)
+{
+	u32 *src, *hdls;
+
+	src = amdxdna_submit_area_ptr(area, offset, cnt, sizeof(u32));
+	if (!src) {
+		XDNA_ERR(xdna, "Invalid arg bo array at 0x%llx in submit area", offset);
+		return ERR_PTR(-EINVAL);
+	}
+
+	hdls = cnt <= buf_cnt ? buf : kmalloc_array(cnt, sizeof(u32), GFP_KERNEL);
+	if (!hdls)
+		return ERR_PTR(-ENOMEM);
+
+	memcpy(hdls, src, cnt * sizeof(u32));
+	return hdls;
+}
+
+/*
+ * Snapshot syncobj handle and point arrays in the submission area, for the
+ * same reason as above. Both arrays live in one allocation starting at
+ * *syncobj_pts, which the caller frees, as with amdxdna_syncobjs_copy().
+ */
+static int amdxdna_syncobjs_in_area(struct amdxdna_dev *xdna, struct amdxdna_gem_obj *area,
+				    u64 hdls_off, u64 pts_off, u32 cnt,
+				    u32 **syncobj_hdls, u64 **syncobj_pts)
+{
+	u32 *src_hdls, *hdls;
+	u64 *src_pts, *pts;
+
+	src_hdls = amdxdna_submit_area_ptr(area, hdls_off, cnt, sizeof(u32));
+	src_pts = amdxdna_submit_area_ptr(area, pts_off, cnt, sizeof(u64));
+	if (!src_hdls || !src_pts) {
+		XDNA_ERR(xdna, "Invalid %d syncobjs at 0x%llx/0x%llx in submit area",
+			 cnt, hdls_off, pts_off);
+		return -EINVAL;
+	}
+
+	pts = kmalloc_array(cnt, sizeof(u64) + sizeof(u32), GFP_KERNEL);
+	if (!pts)
+		return -ENOMEM;
+	hdls = (u32 *)(pts + cnt);
+
+	memcpy(hdls, src_hdls, cnt * sizeof(u32));
+	memcpy(pts, src_pts, cnt * sizeof(u64));
+
+	*syncobj_hdls = hdls;
+	*syncobj_pts = pts;
+	return 0;
+}
+
+/*
+ * Copy syncobj handle and point arrays from user. Both arrays live in one
+ * allocation starting at *syncobj_pts, which the caller frees.
+ */
+static int amdxdna_syncobjs_copy(struct amdxdna_dev *xdna, u64 uhdls, u64 upts, u32 cnt,
+				 u32 **syncobj_hdls, u64 **syncobj_pts)
+{
+	u32 *hdls;
+	u64 *pts;
+
+	pts = kcalloc(cnt, sizeof(u64) + sizeof(u32), GFP_KERNEL);
+	if (!pts)
+		return -ENOMEM;
+	hdls = (u32 *)(pts + cnt);
+
+	if (copy_from_user(hdls, u64_to_user_ptr(uhdls), cnt * sizeof(u32)) ||
+	    copy_from_user(pts, u64_to_user_ptr(upts), cnt * sizeof(u64))) {
+		XDNA_ERR(xdna, "Failed to copy %d syncobjs", cnt);
+		kfree(pts);
+		return -EFAULT;
+	}
+
+	*syncobj_hdls = hdls;
+	*syncobj_pts = pts;
+	return 0;
+}
+
+/*
+ * Signaling syncobjs is split in two steps. amdxdna_signal_prepare() looks up
+ * the syncobjs and allocates chain nodes up front, so that nothing can fail in
+ * amdxdna_signal_commit() once the fence to signal is known. On failure,
+ * amdxdna_signal_prepare() releases everything including buf.
+ */
+struct amdxdna_signal {
+	u32			cnt;
+	u64			*points;
+	/* Allocation backing points if owned, see amdxdna_syncobjs_copy() */
+	void			*buf;
+	struct drm_syncobj	**syncobjs;
+	struct dma_fence_chain	**chains;
+};
+
+static void amdxdna_signal_fini(struct amdxdna_signal *sig)
+{
+	u32 i;
+
+	if (sig->syncobjs) {
+		for (i = 0; i < sig->cnt; i++) {
+			dma_fence_chain_free(sig->chains[i]);
+			if (sig->syncobjs[i])
+				drm_syncobj_put(sig->syncobjs[i]);
+		}
+		kfree(sig->syncobjs);
+	}
+	kfree(sig->buf);
+	memset(sig, 0, sizeof(*sig));
+}
+
+static int amdxdna_signal_prepare(struct amdxdna_client *client, u32 *syncobj_hdls,
+				  u64 *syncobj_pts, u32 syncobj_cnt, struct amdxdna_signal *sig)
+{
+	struct amdxdna_dev *xdna = client->xdna;
+	struct dma_fence *fence;
+	int ret;
+	u32 i;
+
+	sig->syncobjs = kcalloc(syncobj_cnt, sizeof(*sig->syncobjs) + sizeof(*sig->chains),
+				GFP_KERNEL);
+	if (!sig->syncobjs) {
+		ret = -ENOMEM;
+		goto fini;
+	}
+	sig->chains = (struct dma_fence_chain **)(sig->syncobjs + syncobj_cnt);
+	sig->points = syncobj_pts;
+	sig->cnt = syncobj_cnt;
+
+	for (i = 0; i < syncobj_cnt; i++) {
+		sig->syncobjs[i] = drm_syncobj_find(client->filp, syncobj_hdls[i]);
+		if (!sig->syncobjs[i]) {
+			XDNA_ERR(xdna, "Syncobj %d not found", syncobj_hdls[i]);
+			ret = -ENOENT;
+			goto fini;
+		}
+
+		if (!drm_syncobj_find_fence(client->filp, syncobj_hdls[i], syncobj_pts[i],
+					    0, &fence)) {
+			XDNA_ERR(xdna, "Signal for syncobj %d@%lld is already submitted",
+				 syncobj_hdls[i], syncobj_pts[i]);
+			dma_fence_put(fence);
+			continue;
+		}
+
+		sig->chains[i] = dma_fence_chain_alloc();
+		if (!sig->chains[i]) {
+			ret = -ENOMEM;
+			goto fini;
+		}
+	}
+
+	return 0;
+
+fini:
+	amdxdna_signal_fini(sig);
+	return ret;
+}
+
+static void amdxdna_signal_commit(struct amdxdna_signal *sig, struct dma_fence *fence)
+{
+	u32 i;
+
+	for (i = 0; i < sig->cnt; i++) {
+		if (!sig->chains[i])
+			continue;
+
+		drm_syncobj_add_point(sig->syncobjs[i], sig->chains[i], fence, sig->points[i]);
+		sig->chains[i] = NULL;
+	}
+}
+
+static int amdxdna_exec_syncobjs_get(struct amdxdna_client *client, u64 ext,
+				     struct amdxdna_gem_obj *area,
+				     u32 **syncobj_hdls, u64 **syncobj_pts, u32 *syncobj_cnt,
+				     struct amdxdna_signal *sig)
+{
+	struct amdxdna_drm_exec_syncobjs syncobjs;
+	struct amdxdna_dev *xdna = client->xdna;
+	u32 *out_hdls;
+	u64 *out_pts;
+	int ret;
+
+	if (copy_from_user(&syncobjs, u64_to_user_ptr(ext), sizeof(syncobjs)))
+		return -EFAULT;
+
+	if ((!syncobjs.in_count && !syncobjs.out_count) ||
+	    syncobjs.in_count > MAX_ARG_COUNT || syncobjs.out_count > MAX_ARG_COUNT) {
+		XDNA_ERR(xdna, "Invalid in/out fence count %d/%d",
+			 syncobjs.in_count, syncobjs.out_count);
+		return -EINVAL;
+	}
+
+	if (syncobjs.out_count) {
+		ret = amdxdna_syncobjs_copy(xdna, syncobjs.out_handles, syncobjs.out_points,
+					    syncobjs.out_count, &out_hdls, &out_pts);
+		if (ret)
+			return ret;
+
+		sig->buf = out_pts;
+		ret = amdxdna_signal_prepare(client, out_hdls, out_pts, syncobjs.out_count, sig);
+		if (ret)
+			return ret;
+	}
+
+	if (syncobjs.in_count) {
+		if (area)
+			ret = amdxdna_syncobjs_in_area(xdna, area, syncobjs.in_handles,
+						       syncobjs.in_points, syncobjs.in_count,
+						       syncobj_hdls, syncobj_pts);
+		else
+			ret = amdxdna_syncobjs_copy(xdna, syncobjs.in_handles, syncobjs.in_points,
+						    syncobjs.in_count, syncobj_hdls, syncobj_pts);
+		if (ret) {
+			amdxdna_signal_fini(sig);
+			return ret;
+		}
+	}
+
+	*syncobj_cnt = syncobjs.in_count;
+	return 0;
+}
+
+/* Returns a signaled stub if the command is already retired */
+struct dma_fence *amdxdna_cmd_out_fence(struct amdxdna_client *client, u32 ctx_hdl, u64 seq)
+{
+	struct amdxdna_dev *xdna = client->xdna;
+	struct dma_fence *fence = NULL;
+	struct amdxdna_ctx *ctx;
+	int idx;
+
+	idx = srcu_read_lock(&client->ctx_srcu);
+	ctx = xa_load(&client->ctx_xa, ctx_hdl);
+	/* Stub fence for completed command, no need to search for it */
+	if (ctx && seq >= smp_load_acquire(&ctx->completed))
+		fence = xdna->dev_info->ops->cmd_get_out_fence(ctx, seq);
+	srcu_read_unlock(&client->ctx_srcu, idx);
+
+	return fence ? fence : dma_fence_get_stub();
+}
+
 /*
  * The submit command ioctl submits a command to firmware. One firmware command
  * may contain multiple command BOs for processing as a whole.
@@ -505,51 +1072,111 @@ free_job:
 static int amdxdna_drm_submit_execbuf(struct amdxdna_client *client,
 				      struct amdxdna_drm_exec_cmd *args)
 {
+	u32 bo_list_hdl = AMDXDNA_INVALID_BO_LIST_HANDLE;
+	u32 area_hdls[XDNA_AREA_INLINE_ARGS];
+	struct amdxdna_gem_obj *area = NULL;
 	struct amdxdna_dev *xdna = client->xdna;
-	u32 *arg_bo_hdls;
+	u32 *arg_bo_hdls = NULL, arg_bo_cnt = 0;
+	struct amdxdna_signal sig = {};
+	struct dma_fence *out_fence;
+	u32 *syncobj_hdls = NULL;
+	u64 *syncobj_pts = NULL;
+	u32 syncobj_cnt = 0;
 	u32 cmd_bo_hdl;
 	int ret;
 
-	if (!args->arg_count || args->arg_count > MAX_ARG_COUNT) {
-		XDNA_ERR(xdna, "Invalid arg bo count %d", args->arg_count);
-		return -EINVAL;
-	}
-
 	/* Only support single command for now. */
 	if (args->cmd_count != 1) {
 		XDNA_ERR(xdna, "Invalid cmd bo count %d", args->cmd_count);
 		return -EINVAL;
 	}
-
 	cmd_bo_hdl = (u32)args->cmd_handles;
-	arg_bo_hdls = kcalloc(args->arg_count, sizeof(u32), GFP_KERNEL);
-	if (!arg_bo_hdls)
-		return -ENOMEM;
-	ret = copy_from_user(arg_bo_hdls, u64_to_user_ptr(args->args),
-			     args->arg_count * sizeof(u32));
-	if (ret) {
-		ret = -EFAULT;
-		goto free_cmd_bo_hdls;
+
+	if (args->ext_flags & AMDXDNA_EXEC_FLAG_BO_LIST) {
+		if (args->arg_count) {
+			XDNA_ERR(xdna, "Arg bo count %d with BO list", args->arg_count);
+			return -EINVAL;
+		}
+		bo_list_hdl = (u32)args->args;
+	} else if (!args->arg_count || args->arg_count > MAX_ARG_COUNT) {
+		XDNA_ERR(xdna, "Invalid arg bo count %d", args->arg_count);
+		return -EINVAL;
+	}
+
+	ret = amdxdna_client_throttle(client);
+	if (ret)
+		return ret;
+
+	if (args->ext_flags & AMDXDNA_EXEC_FLAG_SUBMIT_AREA) {
+		area = amdxdna_submit_area_get(client, args->ctx, args->seq);
+		if (IS_ERR(area))
+			return PTR_ERR(area);
+	}
+
+	if (args->ext_flags & AMDXDNA_EXEC_FLAG_SYNCOBJS) {
+		ret = amdxdna_exec_syncobjs_get(client, args->ext, area, &syncobj_hdls,
+						&syncobj_pts, &syncobj_cnt, &sig);
+		if (ret)
+			goto put_area;
+	}
+
+	if (area && bo_list_hdl == AMDXDNA_INVALID_BO_LIST_HANDLE) {
+		arg_bo_hdls = amdxdna_arg_bos_in_area(xdna, area, args->args, args->arg_count,
+						      area_hdls, ARRAY_SIZE(area_hdls));
+		if (IS_ERR(arg_bo_hdls)) {
+			ret = PTR_ERR(arg_bo_hdls);
+			arg_bo_hdls = NULL;
+			goto free_syncobjs;
+		}
+		arg_bo_cnt = args->arg_count;
+	} else if (bo_list_hdl == AMDXDNA_INVALID_BO_LIST_HANDLE) {
+		arg_bo_hdls = kcalloc(args->arg_count, sizeof(u32), GFP_KERNEL);
+		if (!arg_bo_hdls) {
+			ret = -ENOMEM;
+			goto free_syncobjs;
+		}
+		ret = copy_from_user(arg_bo_hdls, u64_to_user_ptr(args->args),
+				     args->arg_count * sizeof(u32));
+		if (ret) {
+			ret = -EFAULT;
+			goto free_cmd_bo_hdls;
+		}
+		arg_bo_cnt = args->arg_count;
 	}
 
-	ret = amdxdna_cmd_submit(client, OP_USER, cmd_bo_hdl, arg_bo_hdls,
-				 args->arg_count, NULL, NULL, 0, args->ctx, &args->seq);
+	ret = amdxdna_cmd_submit(client, OP_USER, cmd_bo_hdl, arg_bo_hdls, arg_bo_cnt,
+				 bo_list_hdl, syncobj_hdls, syncobj_pts, syncobj_cnt,
+				 args->ctx, &args->seq);
+	if (ret)
+		goto free_cmd_bo_hdls;
+
+	XDNA_DBG(xdna, "Pushed cmd %lld to scheduler", args->seq);
+	if (sig.cnt) {
+		out_fence = amdxdna_cmd_out_fence(client, args->ctx, args->seq);
+		amdxdna_signal_commit(&sig, out_fence);
+		dma_fence_put(out_fence);
+	}
 
 free_cmd_bo_hdls:
-	kfree(arg_bo_hdls);
-	if (!ret)
-		XDNA_DBG(xdna, "Pushed cmd %lld to scheduler", args->seq);
+	if (arg_bo_hdls != area_hdls)
+		kfree(arg_bo_hdls);
+free_syncobjs:
+	kfree(syncobj_pts);
+	amdxdna_signal_fini(&sig);
+put_area:
+	if (area)
+		amdxdna_gem_put_obj(area);
 	return ret;
 }
 
 static int amdxdna_drm_submit_dependency(struct amdxdna_client *client,
 					 struct amdxdna_drm_exec_cmd *args)
 {
+	struct amdxdna_gem_obj *area = NULL;
 	struct amdxdna_dev *xdna = client->xdna;
 	u32 *syncobj_hdls;
 	u64 *syncobj_pts;
 	u32 syncobj_cnt;
-	void *argbuf;
 	int ret;
 
 	if (!args->cmd_count || args->cmd_count > MAX_ARG_COUNT) {
@@ -563,31 +1190,29 @@ static int amdxdna_drm_submit_dependency(struct amdxdna_client *client,
 	}
 	syncobj_cnt = args->arg_count;
 
-	argbuf = kcalloc(syncobj_cnt, sizeof(u32) + sizeof(u64), GFP_KERNEL);
-	if (!argbuf)
-		return -ENOMEM;
-	syncobj_hdls = argbuf;
-	syncobj_pts = (u64 *)(syncobj_hdls + syncobj_cnt);
+	if (args->ext_flags & AMDXDNA_EXEC_FLAG_SUBMIT_AREA) {
+		area = amdxdna_submit_area_get(client, args->ctx, args->seq);
+		if (IS_ERR(area))
+			return PTR_ERR(area);
 
-	ret = copy_from_user(syncobj_hdls, u64_to_user_ptr(args->cmd_handles),
-			     syncobj_cnt * sizeof(u32));
-	if (ret) {
-		ret = -EFAULT;
-		goto done;
-	}
-	ret = copy_from_user(syncobj_pts, u64_to_user_ptr(args->args),
-			     syncobj_cnt * sizeof(u64));
-	if (ret) {
-		ret = -EFAULT;
-		goto done;
+		ret = amdxdna_syncobjs_in_area(xdna, area, args->cmd_handles, args->args,
+					       syncobj_cnt, &syncobj_hdls, &syncobj_pts);
+	} else {
+		ret = amdxdna_syncobjs_copy(xdna, args->cmd_handles, args->args, syncobj_cnt,
+					    &syncobj_hdls, &syncobj_pts);
 	}
+	if (ret)
+		goto put_area;
 
 	ret = amdxdna_cmd_submit(client, OP_NOOP, AMDXDNA_INVALID_BO_HANDLE, NULL, 0,
+				 AMDXDNA_INVALID_BO_LIST_HANDLE,
 				 syncobj_hdls, syncobj_pts, syncobj_cnt,
 				 args->ctx, &args->seq);
 
-done:
-	kfree(argbuf);
+	kfree(syncobj_pts);
+put_area:
+	if (area)
+		amdxdna_gem_put_obj(area);
 	if (!ret)
 		XDNA_DBG(xdna, "Pushed no-op cmd %lld to scheduler", args->seq);
 	return ret;
@@ -596,38 +1221,41 @@ done:
 static int amdxdna_drm_submit_signal(struct amdxdna_client *client,
 				     struct amdxdna_drm_exec_cmd *args)
 {
-	u32 syncobj_hdl = (u32)args->cmd_handles;
 	struct amdxdna_dev *xdna = client->xdna;
-	struct dma_fence_chain *chain = NULL;
+	struct amdxdna_signal sig = {};
 	struct dma_fence *ofence = NULL;
-	u64 syncobj_pt = args->args;
-	struct drm_syncobj *syncobj;
+	u32 syncobj_cnt = args->cmd_count;
+	u32 *syncobj_hdls, syncobj_hdl;
+	u64 *syncobj_pts, syncobj_pt;
 	u32 ctx_hdl = args->ctx;
 	struct amdxdna_ctx *ctx;
-	int ret = 0;
-	int idx;
+	int ret, idx;
 
-	/* Only support single signal submission for now. */
-	if (args->cmd_count != 1 || args->arg_count != 1) {
-		XDNA_ERR(xdna, "Only support 1 syncobj for signal submission");
+	if (!syncobj_cnt || syncobj_cnt > MAX_ARG_COUNT || args->arg_count != syncobj_cnt) {
+		XDNA_ERR(xdna, "Invalid signal syncobj hdl/pt count (%d/%d)",
+			 args->cmd_count, args->arg_count);
 		return -EINVAL;
 	}
 
-	syncobj = drm_syncobj_find(client->filp, syncobj_hdl);
-	if (!syncobj) {
-		XDNA_ERR(xdna, "Syncobj %d not found", syncobj_hdl);
-		return -ENOENT;
+	if (syncobj_cnt == 1) {
+		/* Single syncobj handle and point are passed by value */
+		syncobj_hdl = (u32)args->cmd_handles;
+		syncobj_pt = args->args;
+		syncobj_hdls = &syncobj_hdl;
+		syncobj_pts = &syncobj_pt;
+	} else {
+		ret = amdxdna_syncobjs_copy(xdna, args->cmd_handles, args->args, syncobj_cnt,
+					    &syncobj_hdls, &syncobj_pts);
+		if (ret)
+			return ret;
+		sig.buf = syncobj_pts;
 	}
 
-	idx = srcu_read_lock(&client->ctx_srcu);
+	ret = amdxdna_signal_prepare(client, syncobj_hdls, syncobj_pts, syncobj_cnt, &sig);
+	if (ret)
+		return ret;
 
-	ret = drm_syncobj_find_fence(client->filp, syncobj_hdl, syncobj_pt, 0, &ofence);
-	if (!ret) {
-		XDNA_ERR(xdna, "Signal for syncobj %d@%lld is already submitted",
-			 syncobj_hdl, syncobj_pt);
-		goto out;
-	}
-	ret = 0;
+	idx = srcu_read_lock(&client->ctx_srcu);
 
 	ctx = xa_load(&client->ctx_xa, ctx_hdl);
 	if (!ctx) {
@@ -636,12 +1264,7 @@ static int amdxdna_drm_submit_signal(struct amdxdna_client *client,
 		goto out;
 	}
 
-	chain = dma_fence_chain_alloc();
-	if (!chain) {
-		ret = -ENOMEM;
-		goto out;
-	}
-
+	/* Resolve the out fence once for all the signal points */
 	if (ctx->submitted)
 		ofence = xdna->dev_info->ops->cmd_get_out_fence(ctx, ctx->submitted - 1);
 	else
@@ -652,14 +1275,12 @@ static int amdxdna_drm_submit_signal(struct amdxdna_client *client,
 		goto out;
 	}
 
-	drm_syncobj_add_point(syncobj, chain, ofence, syncobj_pt);
-	chain = NULL;
+	amdxdna_signal_commit(&sig, ofence);
+	dma_fence_put(ofence);
 
 out:
-	dma_fence_chain_free(chain);
-	dma_fence_put(ofence);
-	drm_syncobj_put(syncobj);
 	srcu_read_unlock(&client->ctx_srcu, idx);
+	amdxdna_signal_fini(&sig);
 	return ret;
 }
 
@@ -667,9 +1288,25 @@ int amdxdna_drm_submit_cmd_ioctl(struct drm_device *dev, void *data, struct drm_
 {
 	struct amdxdna_client *client = filp->driver_priv;
 	struct amdxdna_drm_exec_cmd *args = data;
+	u64 flags;
 
-	if (args->ext || args->ext_flags)
+	if (args->ext_flags & ~(AMDXDNA_EXEC_FLAG_BO_LIST | AMDXDNA_EXEC_FLAG_SYNCOBJS |
+				AMDXDNA_EXEC_FLAG_SUBMIT_AREA))
+		return -EINVAL;
+
+	if (args->ext && !(args->ext_flags & AMDXDNA_EXEC_FLAG_SYNCOBJS))
+		return -EINVAL;
+
+	/* Dependency arrays can also be passed in the submit area */
+	flags = args->ext_flags;
+	if (args->type == AMDXDNA_CMD_SUBMIT_DEPENDENCY)
+		flags &= ~AMDXDNA_EXEC_FLAG_SUBMIT_AREA;
+
+	if (flags && args->type != AMDXDNA_CMD_SUBMIT_EXEC_BUF) {
+		XDNA_ERR(client->xdna, "Flags 0x%llx not for command type %d",
+			 args->ext_flags, args->type);
 		return -EINVAL;
+	}
 
 	switch (args->type) {
 	case AMDXDNA_CMD_SUBMIT_EXEC_BUF:
@@ -704,6 +1341,12 @@ int amdxdna_cmd_wait(struct amdxdna_client *client, u32 ctx_hdl,
 		goto unlock_ctx_srcu;
 	}
 
+	/* Only look up the fence of a command which might be outstanding */
+	if (seq < smp_load_acquire(&ctx->completed)) {
+		ret = 0;
+		goto unlock_ctx_srcu;
+	}
+
 	ret = xdna->dev_info->ops->cmd_wait(ctx, seq, timeout);
 
 unlock_ctx_srcu:
@@ -106,6 +106,12 @@ struct amdxdna_ctx {
 	u32				umq_bo;
 	u32				log_buf_bo;
 	u32				doorbell_offset;
+	/* User VA of the copy of completed */
+	u64				completed_addr;
+	/* mmap() offset of the read-only struct amdxdna_ctx_status page */
+	u64				status_offset;
+	/* Registered submission area, set once */
+	struct amdxdna_gem_obj		*submit_area;
 /*
  * Set CTX_STATE_CONNECTED bit means context is associated
  * with firmware context
@@ -132,9 +138,14 @@ struct amdxdna_ctx {
 
 	/* Counter for pending job */
 	atomic64_t			job_pending_cnt;
-	/* Submitted, completed, freed job counter */
+	/*
+	 * Submitted, completed, freed job counter. Jobs complete in order, so
+	 * job of seq lower than completed is done.
+	 */
 	u64				submitted;
 	u64				completed ____cacheline_aligned_in_smp;
+	/* Counter for failed job, updated under the status lock of device ctx */
+	u64				errors;
 	/* Counter for freed job */
 	atomic64_t			job_free_cnt;
 	/* For TDR worker to keep last completed. low frequency update */
@@ -156,6 +167,16 @@ struct amdxdna_job_bo {
 	bool			locked;
 };
 
+/*
+ * Pre-validated argument BOs. Every BO is referenced and pinned when the list
+ * is created, so submission only needs to take a reference on the list.
+ */
+struct amdxdna_bo_list {
+	struct kref		refcnt;
+	u32			bo_cnt;
+	struct drm_gem_object	*bos[] __counted_by(bo_cnt);
+};
+
 struct amdxdna_sched_job {
 	struct drm_sched_job	base;
 	struct kref		refcnt;
@@ -166,6 +187,8 @@ struct amdxdna_sched_job {
 	/* user can wait on this fence */
 	struct dma_fence	*out_fence;
 	bool			job_done;
+	/* Busy time charged to the client until job_done */
+	bool			charged;
 	u64			seq;
 #define OP_USER			0
 #define OP_SYNC_BO		1
@@ -175,6 +198,10 @@ struct amdxdna_sched_job {
 	u32			opcode;
 	int			msg_id;
 	struct amdxdna_gem_obj	*cmd_bo;
+	/* Allocated from the job cache */
+	bool			cached;
+	/* Holds the references of bos[] if not NULL */
+	struct amdxdna_bo_list	*bo_list;
 	size_t			bo_cnt;
 	struct amdxdna_job_bo	bos[] __counted_by(bo_cnt);
 };
@@ -256,7 +283,12 @@ static inline u32 amdxdna_ctx_col_map(struct amdxdna_ctx *ctx)
 		       ctx->start_col);
 }
 
+int amdxdna_ctx_caches_init(void);
+void amdxdna_ctx_caches_fini(void);
+
 void amdxdna_ctx_wait_jobs(struct amdxdna_ctx *ctx, long timeout);
+struct amdxdna_sched_job *amdxdna_sched_job_alloc(u32 bo_cnt);
+void amdxdna_sched_job_free(struct amdxdna_sched_job *job);
 void amdxdna_sched_job_cleanup(struct amdxdna_sched_job *job);
 void amdxdna_ctx_remove_all(struct amdxdna_client *client);
 
@@ -264,16 +296,21 @@ int amdxdna_lock_objects(struct amdxdna_sched_job *job, struct ww_acquire_ctx *c
 void amdxdna_unlock_objects(struct amdxdna_sched_job *job, struct ww_acquire_ctx *ctx);
 int amdxdna_cmd_submit(struct amdxdna_client *client, u32 opcode,
 		       u32 cmd_bo_hdls, u32 *arg_bo_hdls, u32 arg_bo_cnt,
+		       u32 bo_list_hdl,
 		       u32 *sync_obj_hdls, u64 *sync_obj_pts, u32 sync_obj_cnt,
 		       u32 ctx_hdl, u64 *seq);
+void amdxdna_bo_list_remove_all(struct amdxdna_client *client);
 
 int amdxdna_cmd_wait(struct amdxdna_client *client, u32 ctx_hdl,
 		     u64 seq, u32 timeout);
+struct dma_fence *amdxdna_cmd_out_fence(struct amdxdna_client *client, u32 ctx_hdl, u64 seq);
 
 int amdxdna_drm_create_ctx_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 int amdxdna_drm_config_ctx_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 int amdxdna_drm_destroy_ctx_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 int amdxdna_drm_submit_cmd_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 int amdxdna_drm_wait_cmd_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
+int amdxdna_drm_create_bo_list_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
+int amdxdna_drm_destroy_bo_list_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 
 #endif /* _AMDXDNA_CTX_H_ */
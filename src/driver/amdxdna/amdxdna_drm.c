@@ -3,8 +3,11 @@
  * Copyright (C) 2022-2025, Advanced Micro Devices, Inc.
  */
 
+#include <linux/hrtimer.h>
 #include <linux/iommu.h>
 #include <linux/pm_runtime.h>
+#include <linux/sched/signal.h>
+#include <linux/uaccess.h>
 #include <drm/drm_ioctl.h>
 #include <drm/drm_accel.h>
 #include "drm_local/amdxdna_accel.h"
@@ -17,6 +20,15 @@
 #define CREATE_TRACE_POINTS
 #include "amdxdna_trace.h"
 
+static uint client_budget_pct;
+module_param(client_budget_pct, uint, 0644);
+MODULE_PARM_DESC(client_budget_pct,
+		 "Default NPU time budget of a client in percent of a period, 0 unlimited (Default 0)");
+
+static uint client_budget_period_ms = 100;
+module_param(client_budget_period_ms, uint, 0644);
+MODULE_PARM_DESC(client_budget_period_ms, "NPU time budget accounting period in ms (Default 100)");
+
 static int amdxdna_drm_open(struct drm_device *ddev, struct drm_file *filp)
 {
 	struct amdxdna_dev *xdna = to_xdna_dev(ddev);
@@ -38,6 +50,10 @@ static int amdxdna_drm_open(struct drm_device *ddev, struct drm_file *filp)
 	client->pid = pid_nr(filp->pid);
 	client->xdna = xdna;
 
+	ret = amdxdna_gem_heap_cache_init(client);
+	if (ret)
+		goto failed;
+
 #ifdef AMDXDNA_DEVEL
 	if (iommu_mode != AMDXDNA_IOMMU_PASID)
 		goto skip_sva_bind;
@@ -46,7 +62,7 @@ static int amdxdna_drm_open(struct drm_device *ddev, struct drm_file *filp)
 	if (IS_ERR(client->sva)) {
 		ret = PTR_ERR(client->sva);
 		XDNA_ERR(xdna, "SVA bind device failed, ret %d", ret);
-		goto failed;
+		goto free_heap_cache;
 	}
 	client->pasid = iommu_sva_get_pasid(client->sva);
 	if (client->pasid == IOMMU_PASID_INVALID) {
@@ -59,16 +75,19 @@ skip_sva_bind:
 #endif
 	init_srcu_struct(&client->ctx_srcu);
 	xa_init_flags(&client->ctx_xa, XA_FLAGS_ALLOC);
+	xa_init_flags(&client->bo_list_xa, XA_FLAGS_ALLOC1);
 	mutex_init(&client->mm_lock);
 
-	mutex_lock(&xdna->dev_lock);
-	list_add_tail(&client->node, &xdna->client_list);
-	mutex_unlock(&xdna->dev_lock);
-
 	spin_lock_init(&client->stats.lock);
 	client->stats.job_depth = 0;
 	client->stats.busy_time = ns_to_ktime(0);
 	client->stats.start_time = ns_to_ktime(0);
+	client->stats.budget_pct = min(READ_ONCE(client_budget_pct), 100U);
+	client->stats.period_start = ktime_get();
+
+	mutex_lock(&xdna->dev_lock);
+	list_add_tail_rcu(&client->node, &xdna->client_list);
+	mutex_unlock(&xdna->dev_lock);
 
 	filp->driver_priv = client;
 	client->filp = filp;
@@ -78,6 +97,8 @@ skip_sva_bind:
 
 unbind_sva:
 	iommu_sva_unbind_device(client->sva);
+free_heap_cache:
+	free_percpu(client->heap_cache);
 failed:
 	kfree(client);
 put_rpm:
@@ -96,6 +117,9 @@ static void amdxdna_drm_close(struct drm_device *ddev, struct drm_file *filp)
 
 	xa_destroy(&client->ctx_xa);
 	cleanup_srcu_struct(&client->ctx_srcu);
+	amdxdna_bo_list_remove_all(client);
+	xa_destroy(&client->bo_list_xa);
+	amdxdna_gem_heap_cache_fini(client);
 	mutex_destroy(&client->mm_lock);
 	if (client->dev_heap)
 		drm_gem_object_put(to_gobj(client->dev_heap));
@@ -135,8 +159,14 @@ static int amdxdna_flush(struct file *f, fl_owner_t id)
 	if (!drm_dev_enter(&xdna->ddev, &idx))
 		return 0;
 
+	/*
+	 * GET_INFO walks the client list under client_srcu without dev_lock,
+	 * so waiting for those readers while holding dev_lock is safe.
+	 */
 	mutex_lock(&xdna->dev_lock);
-	list_del_init(&client->node);
+	list_del_rcu(&client->node);
+	synchronize_srcu(&xdna->client_srcu);
+	INIT_LIST_HEAD(&client->node);
 	mutex_unlock(&xdna->dev_lock);
 	amdxdna_ctx_remove_all(client);
 
@@ -170,10 +200,8 @@ static int amdxdna_drm_get_info_ioctl(struct drm_device *dev, void *data, struct
 		return -EOPNOTSUPP;
 
 	XDNA_DBG(xdna, "Request parameter %u", args->param);
-	mutex_lock(&xdna->dev_lock);
-	ret = xdna->dev_info->ops->get_aie_info(client, args);
-	mutex_unlock(&xdna->dev_lock);
-	return ret;
+	/* Device takes dev_lock only for the queries that need it */
+	return xdna->dev_info->ops->get_aie_info(client, args);
 }
 
 static int amdxdna_drm_set_state_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
@@ -203,6 +231,10 @@ static const struct drm_ioctl_desc amdxdna_drm_ioctls[] = {
 	DRM_IOCTL_DEF_DRV(AMDXDNA_CREATE_BO, amdxdna_drm_create_bo_ioctl, 0),
 	DRM_IOCTL_DEF_DRV(AMDXDNA_GET_BO_INFO, amdxdna_drm_get_bo_info_ioctl, 0),
 	DRM_IOCTL_DEF_DRV(AMDXDNA_SYNC_BO, amdxdna_drm_sync_bo_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(AMDXDNA_SYNC_BOS, amdxdna_drm_sync_bos_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(AMDXDNA_CREATE_BOS, amdxdna_drm_create_bos_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(AMDXDNA_CREATE_BO_LIST, amdxdna_drm_create_bo_list_ioctl, 0),
+	DRM_IOCTL_DEF_DRV(AMDXDNA_DESTROY_BO_LIST, amdxdna_drm_destroy_bo_list_ioctl, 0),
 	/* Exectuion */
 	DRM_IOCTL_DEF_DRV(AMDXDNA_EXEC_CMD, amdxdna_drm_submit_cmd_ioctl, 0),
 	DRM_IOCTL_DEF_DRV(AMDXDNA_WAIT_CMD, amdxdna_drm_wait_cmd_ioctl, 0),
@@ -230,21 +262,220 @@ void amdxdna_update_stats(struct amdxdna_client *client, ktime_t time, bool star
 	spin_unlock_irqrestore(&client->stats.lock, flags);
 }
 
+/* Caller must hold stats->lock */
+static ktime_t amdxdna_stats_busy(struct amdxdna_stats *stats, ktime_t now)
+{
+	if (!stats->job_depth)
+		return stats->busy_time;
+
+	return ktime_add(stats->busy_time, ktime_sub(now, stats->start_time));
+}
+
+static ktime_t amdxdna_budget_period(void)
+{
+	return ms_to_ktime(max(READ_ONCE(client_budget_period_ms), 1U));
+}
+
+/*
+ * Move the budget window forward to the period containing @now. Each elapsed
+ * period forgives one allotment, but unused time is not banked, so a client
+ * that overran keeps paying it off while an idle client gets no burst credit.
+ * Caller must hold stats->lock.
+ */
+static void amdxdna_budget_advance(struct amdxdna_stats *stats, ktime_t now,
+				   ktime_t period, ktime_t busy)
+{
+	u64 elapsed, allot;
+
+	if (ktime_before(now, ktime_add(stats->period_start, period)))
+		return;
+
+	elapsed = div64_u64(ktime_to_ns(ktime_sub(now, stats->period_start)),
+			    ktime_to_ns(period));
+	allot = div_u64(ktime_to_ns(period) * stats->budget_pct, 100);
+
+	stats->period_start = ktime_add_ns(stats->period_start, elapsed * ktime_to_ns(period));
+	stats->period_busy = ktime_add_ns(stats->period_busy, elapsed * allot);
+	if (ktime_after(stats->period_busy, busy))
+		stats->period_busy = busy;
+}
+
+/*
+ * amdxdna_client_throttle() -- Wait until the client is within its NPU budget
+ *
+ * Busy time is charged to a client from amdxdna_update_stats(). Once a client
+ * has kept the NPU busy for budget_pct of the current period, new submissions
+ * sleep until the next period starts. Jobs already queued are not affected.
+ *
+ * Return: 0 when the submission may proceed, -ERESTARTSYS on a signal.
+ */
+int amdxdna_client_throttle(struct amdxdna_client *client)
+{
+	struct amdxdna_stats *stats = &client->stats;
+	ktime_t period, busy, now, wait;
+	unsigned long flags;
+	u64 allot;
+
+	for (;;) {
+		/* Keep unbudgeted submissions off the stats lock */
+		if (!READ_ONCE(stats->budget_pct))
+			return 0;
+
+		period = amdxdna_budget_period();
+
+		spin_lock_irqsave(&stats->lock, flags);
+		if (!stats->budget_pct) {
+			spin_unlock_irqrestore(&stats->lock, flags);
+			return 0;
+		}
+
+		now = ktime_get();
+		busy = amdxdna_stats_busy(stats, now);
+		amdxdna_budget_advance(stats, now, period, busy);
+		allot = div_u64(ktime_to_ns(period) * stats->budget_pct, 100);
+		if (ktime_to_ns(ktime_sub(busy, stats->period_busy)) < allot) {
+			spin_unlock_irqrestore(&stats->lock, flags);
+			return 0;
+		}
+		wait = ktime_sub(ktime_add(stats->period_start, period), now);
+		spin_unlock_irqrestore(&stats->lock, flags);
+
+		XDNA_DBG(client->xdna, "PID %d over budget, wait %lld ns",
+			 client->pid, ktime_to_ns(wait));
+		set_current_state(TASK_INTERRUPTIBLE);
+		schedule_hrtimeout(&wait, HRTIMER_MODE_REL);
+
+		spin_lock_irqsave(&stats->lock, flags);
+		stats->throttled_time = ktime_add(stats->throttled_time,
+						  ktime_sub(ktime_get(), now));
+		spin_unlock_irqrestore(&stats->lock, flags);
+
+		if (signal_pending(current))
+			return -ERESTARTSYS;
+	}
+}
+
+int amdxdna_set_client_budget(struct amdxdna_dev *xdna, struct amdxdna_drm_set_state *args)
+{
+	struct amdxdna_drm_set_client_budget budget;
+	struct amdxdna_client *client;
+	unsigned long flags;
+	bool found = false;
+	ktime_t now;
+
+	if (args->buffer_size != sizeof(budget)) {
+		XDNA_ERR(xdna, "Invalid buffer size. Given: %u Need: %lu.",
+			 args->buffer_size, sizeof(budget));
+		return -EINVAL;
+	}
+
+	if (copy_from_user(&budget, u64_to_user_ptr(args->buffer), sizeof(budget))) {
+		XDNA_ERR(xdna, "Failed to copy client budget request into kernel");
+		return -EFAULT;
+	}
+
+	if (budget.budget_pct > 100 || budget.pad) {
+		XDNA_ERR(xdna, "Invalid budget %u%%", budget.budget_pct);
+		return -EINVAL;
+	}
+
+	drm_WARN_ON(&xdna->ddev, !mutex_is_locked(&xdna->dev_lock));
+	list_for_each_entry(client, &xdna->client_list, node) {
+		if (client->pid != budget.pid)
+			continue;
+
+		spin_lock_irqsave(&client->stats.lock, flags);
+		now = ktime_get();
+		WRITE_ONCE(client->stats.budget_pct, budget.budget_pct);
+		client->stats.period_start = now;
+		client->stats.period_busy = amdxdna_stats_busy(&client->stats, now);
+		spin_unlock_irqrestore(&client->stats.lock, flags);
+		found = true;
+	}
+
+	if (!found) {
+		XDNA_ERR(xdna, "No client with PID %lld", budget.pid);
+		return -ESRCH;
+	}
+
+	XDNA_INFO(xdna, "PID %lld NPU budget %u%%", budget.pid, budget.budget_pct);
+	return 0;
+}
+
+int amdxdna_get_client_usage(struct amdxdna_dev *xdna, struct amdxdna_drm_get_info *args)
+{
+	struct amdxdna_drm_query_client_usage __user *buf;
+	struct amdxdna_drm_query_client_usage tmp;
+	struct amdxdna_client *client;
+	ktime_t period, busy, now;
+	unsigned long flags;
+	u32 req_bytes = 0;
+	u32 i = 0;
+	int ret = 0;
+	int idx;
+
+	buf = u64_to_user_ptr(args->buffer);
+	period = amdxdna_budget_period();
+	idx = srcu_read_lock(&xdna->client_srcu);
+	list_for_each_entry_srcu(client, &xdna->client_list, node,
+				 srcu_read_lock_held(&xdna->client_srcu)) {
+		req_bytes += sizeof(tmp);
+		if (args->buffer_size < req_bytes)
+			continue;
+
+		memset(&tmp, 0, sizeof(tmp));
+		spin_lock_irqsave(&client->stats.lock, flags);
+		now = ktime_get();
+		busy = amdxdna_stats_busy(&client->stats, now);
+		if (client->stats.budget_pct) {
+			amdxdna_budget_advance(&client->stats, now, period, busy);
+			tmp.period_busy_ns = ktime_to_ns(ktime_sub(busy, client->stats.period_busy));
+		}
+		tmp.busy_ns = ktime_to_ns(busy);
+		tmp.throttled_ns = ktime_to_ns(client->stats.throttled_time);
+		tmp.budget_pct = client->stats.budget_pct;
+		spin_unlock_irqrestore(&client->stats.lock, flags);
+
+		tmp.pid = client->pid;
+		tmp.period_ns = ktime_to_ns(period);
+		tmp.allotted_ns = div_u64(tmp.period_ns * tmp.budget_pct, 100);
+		if (copy_to_user(&buf[i], &tmp, sizeof(tmp))) {
+			ret = -EFAULT;
+			break;
+		}
+		i++;
+	}
+	srcu_read_unlock(&xdna->client_srcu, idx);
+
+	if (!ret && args->buffer_size < req_bytes) {
+		XDNA_ERR(xdna, "Invalid buffer size. Given: %u Need: %u.",
+			 args->buffer_size, req_bytes);
+		ret = -EINVAL;
+	}
+
+	args->buffer_size = req_bytes;
+	return ret;
+}
+
 static void amdxdna_show_fdinfo(struct drm_printer *p, struct drm_file *filp)
 {
 	struct amdxdna_client *client = filp->driver_priv;
 	const char *engine_npu_name = "npu-amdxdna";
 	unsigned long flags;
+	u32 budget_pct;
 	u64 busy_ns;
 
 	spin_lock_irqsave(&client->stats.lock, flags);
-	busy_ns = ktime_to_ns(client->stats.busy_time);
-	if (client->stats.job_depth > 0)
-		busy_ns += ktime_to_ns(ktime_sub(ktime_get(), client->stats.start_time));
+	busy_ns = ktime_to_ns(amdxdna_stats_busy(&client->stats, ktime_get()));
+	budget_pct = client->stats.budget_pct;
 	spin_unlock_irqrestore(&client->stats.lock, flags);
 
+#ifdef AMDXDNA_DRM_USAGE
 	/* see Documentation/gpu/drm-usage-stats.rst */
 	drm_printf(p, "drm-engine-%s:\t%llu ns\n", engine_npu_name, busy_ns);
+#endif
+	if (budget_pct)
+		drm_printf(p, "amdxdna-budget:\t%u%%\n", budget_pct);
 
 	drm_show_memory_stats(p, filp);
 }
@@ -122,6 +122,8 @@ struct amdxdna_dev {
 
 	struct mutex			dev_lock; /* protect client list, xrs_hdl */
 	struct list_head		client_list;
+	/* Lets GET_INFO walk client_list without taking dev_lock */
+	struct srcu_struct		client_srcu;
 	struct amdxdna_fw_ver		fw_ver;
 	struct amdxdna_tdr		tdr;
 #ifdef AMDXDNA_DEVEL
@@ -140,6 +142,12 @@ struct amdxdna_stats {
 	u32				job_depth;
 	ktime_t				busy_time;
 	ktime_t				start_time;
+
+	/* NPU time budget, see amdxdna_client_throttle() */
+	u32				budget_pct;
+	ktime_t				period_start;
+	ktime_t				period_busy;
+	ktime_t				throttled_time;
 };
 
 /*
@@ -150,10 +158,13 @@ struct amdxdna_stats {
  * @pid: PID of current client
  * @ctx_srcu: Per client SRCU for synchronizing ctx destroy with other ioctls.
  * @ctx_xa: context xarray
+ * @bo_list_xa: BO list xarray
  * @xdna: XDNA device pointer
  * @filp: DRM file pointer
  * @mm_lock: lock for client wide memory related
  * @dev_heap: Shared device heap memory
+ * @heap_cache: Per-CPU cache of free device heap chunks
+ * @heap_cache_work: Drains heap_cache when frees stop or the heap is unmapped
  * @sva: iommu SVA handle
  * @pasid: PASID
  * @stats: record npu usage stats
@@ -165,11 +176,14 @@ struct amdxdna_client {
 	struct srcu_struct		ctx_srcu;
 	struct xarray			ctx_xa;
 	u32				next_ctxid;
+	struct xarray			bo_list_xa;
 	struct amdxdna_dev		*xdna;
 	struct drm_file			*filp;
 
 	struct mutex			mm_lock; /* protect memory related */
 	struct amdxdna_gem_obj		*dev_heap;
+	struct amdxdna_heap_cache __percpu *heap_cache;
+	struct delayed_work		heap_cache_work;
 
 	struct iommu_sva		*sva;
 	int				pasid;
@@ -183,5 +197,8 @@ struct amdxdna_client {
 	xa_empty(&(client)->ctx_xa)
 
 void amdxdna_update_stats(struct amdxdna_client *client, ktime_t time, bool start);
+int amdxdna_client_throttle(struct amdxdna_client *client);
+int amdxdna_set_client_budget(struct amdxdna_dev *xdna, struct amdxdna_drm_set_state *args);
+int amdxdna_get_client_usage(struct amdxdna_dev *xdna, struct amdxdna_drm_get_info *args);
 
 #endif /* _AMDXDNA_DRM_H_ */
@@ -6,12 +6,15 @@
 #include "drm_local/amdxdna_accel.h"
 #include <linux/dma-buf.h>
 #include <linux/dma-direct.h>
+#include <linux/dma-fence-array.h>
+#include <linux/dma-fence-chain.h>
 #include <linux/iosys-map.h>
 #include <linux/pagemap.h>
 #include <linux/pfn.h>
 #include <linux/version.h>
 #include <linux/vmalloc.h>
 #include <drm/drm_cache.h>
+#include <drm/drm_syncobj.h>
 
 #include "amdxdna_drm.h"
 #include "amdxdna_gem.h"
@@ -21,6 +24,13 @@
 #endif
 
 #define XDNA_MAX_CMD_BO_SIZE	SZ_32K
+#define XDNA_MAX_SYNC_BO_COUNT	1024
+#define XDNA_MAX_CREATE_BO_COUNT	1024
+
+#define XDNA_HEAP_CACHE_DEPTH	16 /* Max cached chunks per order per CPU */
+#define XDNA_HEAP_CARVE_SIZE	SZ_64K /* Small chunks are carved in batches up to */
+#define XDNA_HEAP_CARVE_MAX	4
+#define XDNA_HEAP_CACHE_IDLE	msecs_to_jiffies(1000) /* Drain after no free for */
 
 #if KERNEL_VERSION(6, 13, 0) > LINUX_VERSION_CODE
 MODULE_IMPORT_NS(DMA_BUF);
@@ -28,16 +38,173 @@ MODULE_IMPORT_NS(DMA_BUF);
 MODULE_IMPORT_NS("DMA_BUF");
 #endif
 
+/* Page order of a cacheable heap chunk, -1 if size can't be cached */
+static int amdxdna_heap_chunk_order(size_t size)
+{
+	int order;
+
+	if (size < PAGE_SIZE || !is_power_of_2(size))
+		return -1;
+
+	order = ilog2(size) - PAGE_SHIFT;
+	return order < AMDXDNA_HEAP_CACHE_ORDERS ? order : -1;
+}
+
+static struct amdxdna_heap_chunk *
+amdxdna_heap_cache_get(struct amdxdna_client *client, int order)
+{
+	struct amdxdna_heap_chunk *chunk;
+	struct amdxdna_heap_cache *cache;
+
+	cache = get_cpu_ptr(client->heap_cache);
+	spin_lock(&cache->lock);
+	chunk = list_first_entry_or_null(&cache->free[order],
+					 struct amdxdna_heap_chunk, entry);
+	if (chunk) {
+		list_del(&chunk->entry);
+		cache->cnt[order]--;
+	}
+	spin_unlock(&cache->lock);
+	put_cpu_ptr(client->heap_cache);
+
+	return chunk;
+}
+
+static bool
+amdxdna_heap_cache_put(struct amdxdna_client *client, int order,
+		       struct amdxdna_heap_chunk *chunk)
+{
+	struct amdxdna_heap_cache *cache;
+	bool cached = false;
+
+	cache = get_cpu_ptr(client->heap_cache);
+	spin_lock(&cache->lock);
+	if (cache->cnt[order] < XDNA_HEAP_CACHE_DEPTH) {
+		list_add(&chunk->entry, &cache->free[order]);
+		cache->cnt[order]++;
+		cached = true;
+	}
+	spin_unlock(&cache->lock);
+	put_cpu_ptr(client->heap_cache);
+
+	return cached;
+}
+
+/* Give all cached chunks back to the heap, caller holds mm_lock */
+static bool amdxdna_heap_cache_drain(struct amdxdna_client *client)
+{
+	struct amdxdna_heap_chunk *chunk, *tmp;
+	struct amdxdna_heap_cache *cache;
+	LIST_HEAD(chunks);
+	int cpu, order;
+
+	for_each_possible_cpu(cpu) {
+		cache = per_cpu_ptr(client->heap_cache, cpu);
+		spin_lock(&cache->lock);
+		for (order = 0; order < AMDXDNA_HEAP_CACHE_ORDERS; order++) {
+			list_splice_init(&cache->free[order], &chunks);
+			cache->cnt[order] = 0;
+		}
+		spin_unlock(&cache->lock);
+	}
+
+	if (list_empty(&chunks))
+		return false;
+
+	list_for_each_entry_safe(chunk, tmp, &chunks, entry) {
+		drm_mm_remove_node(&chunk->node);
+		kfree(chunk);
+	}
+	return true;
+}
+
+static void amdxdna_heap_cache_work(struct work_struct *work)
+{
+	struct amdxdna_client *client;
+
+	client = container_of(to_delayed_work(work), struct amdxdna_client,
+			      heap_cache_work);
+	mutex_lock(&client->mm_lock);
+	amdxdna_heap_cache_drain(client);
+	mutex_unlock(&client->mm_lock);
+}
+
+/*
+ * A cached chunk is only reused when the heap it was carved from is still the
+ * client's heap and still mapped, the same checks a miss does under mm_lock.
+ */
+static bool
+amdxdna_heap_chunk_valid(struct amdxdna_gem_obj *heap,
+			 struct amdxdna_heap_chunk *chunk, size_t size)
+{
+	if (!heap || heap->mem.userptr == AMDXDNA_INVALID_ADDR)
+		return false;
+
+	if (chunk->node.size != size || chunk->node.start < heap->mem.dev_addr)
+		return false;
+
+	return chunk->node.start + size <= heap->mem.dev_addr + heap->mem.size;
+}
+
+/* Caller holds mm_lock */
+static struct amdxdna_heap_chunk *
+amdxdna_heap_chunk_insert(struct amdxdna_client *client, size_t size, u32 align)
+{
+	struct amdxdna_gem_obj *heap = client->dev_heap;
+	struct amdxdna_heap_chunk *chunk;
+	int ret;
+
+	chunk = kzalloc(sizeof(*chunk), GFP_KERNEL);
+	if (!chunk)
+		return ERR_PTR(-ENOMEM);
+
+	ret = drm_mm_insert_node_generic(&heap->mm, &chunk->node, size,
+					 align, 0, DRM_MM_INSERT_BEST);
+	/* Free chunks cached by other CPUs may be what is missing */
+	if (ret == -ENOSPC && amdxdna_heap_cache_drain(client))
+		ret = drm_mm_insert_node_generic(&heap->mm, &chunk->node, size,
+						 align, 0, DRM_MM_INSERT_BEST);
+	if (ret) {
+		kfree(chunk);
+		return ERR_PTR(ret);
+	}
+
+	return chunk;
+}
+
+/*
+ * Power-of-two sized chunks are first looked up in the per-CPU cache. On a
+ * miss, small chunks are carved in a batch under one mm_lock and the extra
+ * ones are cached for following allocations.
+ */
 static int
 amdxdna_gem_heap_alloc(struct amdxdna_gem_obj *abo)
 {
 	struct amdxdna_client *client = abo->client;
 	struct amdxdna_dev *xdna = client->xdna;
+	struct amdxdna_heap_chunk *chunk, *extra;
 	struct amdxdna_mem *mem = &abo->mem;
 	struct amdxdna_gem_obj *heap;
+	int order, nr, i;
 	u64 offset;
 	u32 align;
-	int ret;
+
+	order = amdxdna_heap_chunk_order(mem->size);
+	if (order >= 0) {
+		chunk = amdxdna_heap_cache_get(client, order);
+		if (chunk) {
+			heap = READ_ONCE(client->dev_heap);
+			if (amdxdna_heap_chunk_valid(heap, chunk, mem->size))
+				goto assign;
+
+			/* Drop everything cached, the checks below report why */
+			mutex_lock(&client->mm_lock);
+			drm_mm_remove_node(&chunk->node);
+			kfree(chunk);
+			amdxdna_heap_cache_drain(client);
+			mutex_unlock(&client->mm_lock);
+		}
+	}
 
 	mutex_lock(&client->mm_lock);
 
@@ -61,37 +228,98 @@ amdxdna_gem_heap_alloc(struct amdxdna_gem_obj *abo)
 	}
 
 	align = 1 << max(PAGE_SHIFT, xdna->dev_info->dev_mem_buf_shift);
-	ret = drm_mm_insert_node_generic(&heap->mm, &abo->mm_node, mem->size,
-					 align, 0, DRM_MM_INSERT_BEST);
-	if (ret) {
-		XDNA_ERR(xdna, "Failed to alloc dev bo memory, ret %d", ret);
+	chunk = amdxdna_heap_chunk_insert(client, mem->size, align);
+	if (IS_ERR(chunk)) {
+		XDNA_ERR(xdna, "Failed to alloc dev bo memory, ret %ld", PTR_ERR(chunk));
 		mutex_unlock(&client->mm_lock);
-		return ret;
+		return PTR_ERR(chunk);
 	}
 
-	mem->dev_addr = abo->mm_node.start;
-	offset = mem->dev_addr - client->dev_heap->mem.dev_addr;
-	mem->userptr = client->dev_heap->mem.userptr + offset;
-	if (client->dev_heap->base.pages) {
-		mem->pages = &client->dev_heap->base.pages[offset >> PAGE_SHIFT];
+	nr = order >= 0 ? min(XDNA_HEAP_CARVE_SIZE >> (order + PAGE_SHIFT), XDNA_HEAP_CARVE_MAX) : 1;
+	for (i = 1; i < nr; i++) {
+		extra = amdxdna_heap_chunk_insert(client, mem->size, align);
+		if (IS_ERR(extra))
+			break;
+
+		if (!amdxdna_heap_cache_put(client, order, extra)) {
+			drm_mm_remove_node(&extra->node);
+			kfree(extra);
+			break;
+		}
+	}
+
+	mutex_unlock(&client->mm_lock);
+
+assign:
+	abo->chunk = chunk;
+	mem->dev_addr = chunk->node.start;
+	offset = mem->dev_addr - heap->mem.dev_addr;
+	mem->userptr = heap->mem.userptr + offset;
+	if (heap->base.pages) {
+		mem->pages = &heap->base.pages[offset >> PAGE_SHIFT];
 		mem->nr_pages = mem->size >> PAGE_SHIFT;
 	}
 
 	drm_gem_object_get(to_gobj(heap));
-
-	mutex_unlock(&client->mm_lock);
 	return 0;
 }
 
 static void
 amdxdna_gem_heap_free(struct amdxdna_gem_obj *abo)
 {
-	mutex_lock(&abo->client->mm_lock);
+	struct amdxdna_heap_chunk *chunk = abo->chunk;
+	struct amdxdna_client *client = abo->client;
+	int order;
 
-	drm_mm_remove_node(&abo->mm_node);
-	drm_gem_object_put(to_gobj(abo->client->dev_heap));
+	if (!chunk)
+		return;
+	abo->chunk = NULL;
+
+	/* The cache is gone once the client is closed */
+	order = client->heap_cache ? amdxdna_heap_chunk_order(abo->mem.size) : -1;
+	if (order < 0 || !amdxdna_heap_cache_put(client, order, chunk)) {
+		mutex_lock(&client->mm_lock);
+		drm_mm_remove_node(&chunk->node);
+		mutex_unlock(&client->mm_lock);
+		kfree(chunk);
+	} else {
+		/* Cached chunks pin heap space, give it back once frees stop */
+		mod_delayed_work(system_wq, &client->heap_cache_work,
+				 XDNA_HEAP_CACHE_IDLE);
+	}
 
-	mutex_unlock(&abo->client->mm_lock);
+	drm_gem_object_put(to_gobj(client->dev_heap));
+}
+
+int amdxdna_gem_heap_cache_init(struct amdxdna_client *client)
+{
+	struct amdxdna_heap_cache *cache;
+	int cpu, order;
+
+	client->heap_cache = alloc_percpu(struct amdxdna_heap_cache);
+	if (!client->heap_cache)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		cache = per_cpu_ptr(client->heap_cache, cpu);
+		spin_lock_init(&cache->lock);
+		for (order = 0; order < AMDXDNA_HEAP_CACHE_ORDERS; order++)
+			INIT_LIST_HEAD(&cache->free[order]);
+	}
+	INIT_DELAYED_WORK(&client->heap_cache_work, amdxdna_heap_cache_work);
+
+	return 0;
+}
+
+void amdxdna_gem_heap_cache_fini(struct amdxdna_client *client)
+{
+	cancel_delayed_work_sync(&client->heap_cache_work);
+	mutex_lock(&client->mm_lock);
+	amdxdna_heap_cache_drain(client);
+	mutex_unlock(&client->mm_lock);
+
+	free_percpu(client->heap_cache);
+	client->heap_cache = NULL;
 }
 
 static bool amdxdna_hmm_invalidate(struct mmu_interval_notifier *mni,
@@ -122,6 +350,9 @@ static bool amdxdna_hmm_invalidate(struct mmu_interval_notifier *mni,
 		if (!mapp->unmapped) {
 			queue_work(xdna->notifier_wq, &mapp->hmm_unreg_work);
 			mapp->unmapped = true;
+			/* The VMA still holds the file, so the client is alive */
+			if (abo->type == AMDXDNA_BO_DEV_HEAP)
+				mod_delayed_work(system_wq, &abo->client->heap_cache_work, 0);
 		}
 		up_write(&xdna->notifier_lock);
 	}
@@ -403,6 +634,18 @@ static int amdxdna_gem_shmem_insert_pages(struct amdxdna_gem_obj *abo,
 	return 0;
 }
 
+static int amdxdna_gem_mmap_check(struct amdxdna_gem_obj *abo, struct vm_area_struct *vma)
+{
+	if (!(abo->flags & BO_READ_ONLY))
+		return 0;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	/* No mprotect() to writable later on */
+	vm_flags_clear(vma, VM_MAYWRITE);
+	return 0;
+}
+
 static int amdxdna_gem_shmem_obj_mmap(struct drm_gem_object *gobj,
 				      struct vm_area_struct *vma)
 {
@@ -410,6 +653,10 @@ static int amdxdna_gem_shmem_obj_mmap(struct drm_gem_object *gobj,
 	struct amdxdna_gem_obj *abo = to_xdna_obj(gobj);
 	int ret;
 
+	ret = amdxdna_gem_mmap_check(abo, vma);
+	if (ret)
+		return ret;
+
 	ret = amdxdna_hmm_register(abo, vma);
 	if (ret)
 		return ret;
@@ -472,6 +719,10 @@ static int amdxdna_gem_carvedout_obj_mmap(struct drm_gem_object *gobj,
 	struct amdxdna_gem_obj *abo = to_xdna_obj(gobj);
 	int ret;
 
+	ret = amdxdna_gem_mmap_check(abo, vma);
+	if (ret)
+		return ret;
+
 	ret = amdxdna_hmm_register(abo, vma);
 	if (ret)
 		return ret;
@@ -883,6 +1134,15 @@ amdxdna_drm_create_dev_bo(struct drm_device *dev, struct amdxdna_drm_create_bo *
 		goto release_obj;
 	}
 
+	/*
+	 * The heap reference taken by amdxdna_gem_heap_alloc() keeps the
+	 * shared reservation object alive for the lifetime of this BO.
+	 */
+	if (args->flags & AMDXDNA_BO_FLAG_CLIENT_RESV) {
+		gobj->resv = to_gobj(client->dev_heap)->resv;
+		abo->flags |= BO_CLIENT_RESV;
+	}
+
 	ret = drm_gem_vmap_unlocked(gobj, &map);
 	if (ret) {
 		XDNA_ERR(xdna, "Vmap dev bo failed, ret %d", ret);
@@ -939,6 +1199,61 @@ release_obj:
 	return ERR_PTR(ret);
 }
 
+/*
+ * BO written by driver and read by user through its map offset only. It has
+ * no handle, user can't map it writable or pass it to any ioctl.
+ */
+struct amdxdna_gem_obj *
+amdxdna_gem_create_ro_bo(struct amdxdna_client *client, size_t size)
+{
+	struct amdxdna_dev *xdna = client->xdna;
+	struct amdxdna_gem_obj *abo;
+	struct drm_gem_object *gobj;
+	struct iosys_map map;
+	int ret;
+
+	abo = amdxdna_gem_create_share_object(&xdna->ddev, size);
+	if (IS_ERR(abo))
+		return abo;
+
+	abo->type = AMDXDNA_BO_SHARE;
+	abo->client = client;
+	abo->flags |= BO_READ_ONLY;
+	gobj = to_gobj(abo);
+
+	ret = drm_gem_vmap_unlocked(gobj, &map);
+	if (ret) {
+		XDNA_ERR(xdna, "Vmap read-only bo failed, ret %d", ret);
+		amdxdna_gem_destroy_share_object(abo);
+		return ERR_PTR(ret);
+	}
+	if (!abo->mem.kva)
+		abo->mem.kva = map.vaddr;
+
+	ret = drm_gem_create_mmap_offset(gobj);
+	if (ret)
+		goto put_obj;
+
+	ret = drm_vma_node_allow(&gobj->vma_node, client->filp);
+	if (ret)
+		goto put_obj;
+
+	return abo;
+
+put_obj:
+	drm_gem_object_put(gobj);
+	return ERR_PTR(ret);
+}
+
+void amdxdna_gem_destroy_ro_bo(struct amdxdna_gem_obj *abo)
+{
+	struct drm_gem_object *gobj = to_gobj(abo);
+
+	/* Existing user mappings hold their own reference */
+	drm_vma_node_revoke(&gobj->vma_node, abo->client->filp);
+	drm_gem_object_put(gobj);
+}
+
 static struct amdxdna_gem_obj *
 amdxdna_drm_create_guest_bo(struct drm_device *dev,
 			    struct amdxdna_drm_create_bo *args,
@@ -1031,15 +1346,21 @@ free_va_tbl:
 	return ERR_PTR(ret);
 };
 
-int amdxdna_drm_create_bo_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
+static struct amdxdna_gem_obj *
+amdxdna_gem_create_bo(struct drm_device *dev, struct amdxdna_drm_create_bo *args,
+		      struct drm_file *filp)
 {
 	struct amdxdna_dev *xdna = to_xdna_dev(dev);
-	struct amdxdna_drm_create_bo *args = data;
 	struct amdxdna_gem_obj *abo;
+#ifdef AMDXDNA_DEVEL
 	int ret;
+#endif
 
-	if (args->flags)
-		return -EINVAL;
+	if (args->flags & ~AMDXDNA_BO_FLAG_CLIENT_RESV)
+		return ERR_PTR(-EINVAL);
+
+	if ((args->flags & AMDXDNA_BO_FLAG_CLIENT_RESV) && args->type != AMDXDNA_BO_DEV)
+		return ERR_PTR(-EINVAL);
 
 	XDNA_DBG(xdna, "BO arg type %d vaddr 0x%llx size 0x%llx flags 0x%llx",
 		 args->type, args->vaddr, args->size, args->flags);
@@ -1061,8 +1382,10 @@ int amdxdna_drm_create_bo_ioctl(struct drm_device *dev, void *data, struct drm_f
 		abo->mem.pages = abo->base.pages;
 		abo->mem.nr_pages = to_gobj(abo)->size >> PAGE_SHIFT;
 		ret = amdxdna_mem_map(xdna, &abo->mem);
-		if (ret)
-			goto put_obj;
+		if (ret) {
+			drm_gem_object_put(to_gobj(abo));
+			return ERR_PTR(ret);
+		}
 		abo->mem.dev_addr = abo->mem.dma_addr;
 #endif
 		break;
@@ -1070,8 +1393,28 @@ int amdxdna_drm_create_bo_ioctl(struct drm_device *dev, void *data, struct drm_f
 		abo = amdxdna_drm_create_guest_bo(dev, args, filp);
 		break;
 	default:
-		return -EINVAL;
+		return ERR_PTR(-EINVAL);
 	}
+
+	return abo;
+}
+
+static u64 amdxdna_gem_map_offset(struct amdxdna_gem_obj *abo)
+{
+	if (abo->type == AMDXDNA_BO_DEV)
+		return AMDXDNA_INVALID_ADDR;
+
+	return drm_vma_node_offset_addr(&to_gobj(abo)->vma_node);
+}
+
+int amdxdna_drm_create_bo_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
+{
+	struct amdxdna_dev *xdna = to_xdna_dev(dev);
+	struct amdxdna_drm_create_bo *args = data;
+	struct amdxdna_gem_obj *abo;
+	int ret;
+
+	abo = amdxdna_gem_create_bo(dev, args, filp);
 	if (IS_ERR(abo))
 		return PTR_ERR(abo);
 
@@ -1091,6 +1434,85 @@ put_obj:
 	return ret;
 }
 
+int amdxdna_drm_create_bos_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
+{
+	struct amdxdna_dev *xdna = to_xdna_dev(dev);
+	struct amdxdna_drm_create_bos_entry *entries;
+	struct amdxdna_drm_create_bos *args = data;
+	struct amdxdna_drm_create_bo cbo;
+	struct amdxdna_gem_obj *abo;
+	int ret = 0;
+	u32 i;
+
+	if (args->ext || args->ext_flags || args->pad)
+		return -EINVAL;
+
+	if (!args->count || args->count > XDNA_MAX_CREATE_BO_COUNT) {
+		XDNA_ERR(xdna, "Invalid create bo count %d", args->count);
+		return -EINVAL;
+	}
+
+	entries = kvcalloc(args->count, sizeof(*entries), GFP_KERNEL);
+	if (!entries)
+		return -ENOMEM;
+
+	if (copy_from_user(entries, u64_to_user_ptr(args->entries),
+			   args->count * sizeof(*entries))) {
+		ret = -EFAULT;
+		goto free_entries;
+	}
+
+	for (i = 0; i < args->count; i++) {
+		/* Heap is a singleton and guest BO takes a VA table, neither batches */
+		if (entries[i].type != AMDXDNA_BO_SHARE && entries[i].type != AMDXDNA_BO_DEV &&
+		    entries[i].type != AMDXDNA_BO_CMD) {
+			XDNA_ERR(xdna, "Invalid bo entry %d type %d", i, entries[i].type);
+			ret = -EINVAL;
+			goto delete_handles;
+		}
+
+		cbo = (struct amdxdna_drm_create_bo) {
+			.flags = entries[i].flags,
+			.size = entries[i].size,
+			.type = entries[i].type,
+		};
+		abo = amdxdna_gem_create_bo(dev, &cbo, filp);
+		if (IS_ERR(abo)) {
+			ret = PTR_ERR(abo);
+			XDNA_ERR(xdna, "Create bo entry %d failed, ret %d", i, ret);
+			goto delete_handles;
+		}
+
+		ret = drm_gem_handle_create(filp, to_gobj(abo), &entries[i].handle);
+		if (ret) {
+			XDNA_ERR(xdna, "Create handle failed");
+			drm_gem_object_put(to_gobj(abo));
+			goto delete_handles;
+		}
+
+		entries[i].map_offset = amdxdna_gem_map_offset(abo);
+		entries[i].vaddr = abo->mem.userptr;
+		entries[i].xdna_addr = abo->mem.dev_addr;
+		drm_gem_object_put(to_gobj(abo));
+	}
+
+	if (copy_to_user(u64_to_user_ptr(args->entries), entries,
+			 args->count * sizeof(*entries))) {
+		ret = -EFAULT;
+		goto delete_handles;
+	}
+
+	XDNA_DBG(xdna, "Created %d BOs", args->count);
+	goto free_entries;
+
+delete_handles:
+	while (i--)
+		drm_gem_handle_delete(filp, entries[i].handle);
+free_entries:
+	kvfree(entries);
+	return ret;
+}
+
 int amdxdna_gem_pin_nolock(struct amdxdna_gem_obj *abo)
 {
 	struct amdxdna_dev *xdna = to_xdna_dev(to_gobj(abo)->dev);
@@ -1180,11 +1602,7 @@ int amdxdna_drm_get_bo_info_ioctl(struct drm_device *dev, void *data, struct drm
 	abo = to_xdna_obj(gobj);
 	args->vaddr = abo->mem.userptr;
 	args->xdna_addr = abo->mem.dev_addr;
-
-	if (abo->type != AMDXDNA_BO_DEV)
-		args->map_offset = drm_vma_node_offset_addr(&gobj->vma_node);
-	else
-		args->map_offset = AMDXDNA_INVALID_ADDR;
+	args->map_offset = amdxdna_gem_map_offset(abo);
 
 	XDNA_DBG(xdna, "BO hdl %d map_offset 0x%llx vaddr 0x%llx xdna_addr 0x%llx",
 		 args->handle, args->map_offset, args->vaddr, args->xdna_addr);
@@ -1245,24 +1663,22 @@ amdxdna_drm_clflush(struct amdxdna_gem_obj *abo, u32 start, u32 size)
 }
 
 /*
- * The sync bo ioctl is to make sure the CPU cache is in sync with memory.
- * This is required because NPU is not cache coherent device. CPU cache
- * flushing/invalidation is expensive so it is best to handle this outside
- * of the command submission path. This ioctl allows explicit cache
- * flushing/invalidation outside of the critical path.
+ * Sync one BO range. If the BO is assigned to a context and the sync is from
+ * device, an OP_SYNC_BO command is submitted without waiting for it. Its
+ * context and sequence number are returned in ctx_hdl and seq. Otherwise,
+ * ctx_hdl is AMDXDNA_INVALID_CTX_HANDLE.
  */
-int amdxdna_drm_sync_bo_ioctl(struct drm_device *dev,
-			      void *data, struct drm_file *filp)
+static int amdxdna_gem_sync_bo(struct amdxdna_client *client, struct amdxdna_drm_sync_bo *args,
+			       u32 *ctx_hdl, u64 *seq)
 {
-	struct amdxdna_client *client = filp->driver_priv;
-	struct amdxdna_dev *xdna = to_xdna_dev(dev);
-	struct amdxdna_drm_sync_bo *args = data;
+	struct amdxdna_dev *xdna = client->xdna;
 	struct amdxdna_gem_obj *abo;
 	struct drm_gem_object *gobj;
-	u32 ctx_hdl;
 	int ret;
 
-	gobj = drm_gem_object_lookup(filp, args->handle);
+	*ctx_hdl = AMDXDNA_INVALID_CTX_HANDLE;
+
+	gobj = drm_gem_object_lookup(client->filp, args->handle);
 	if (!gobj) {
 		XDNA_ERR(xdna, "Lookup GEM object failed");
 		return -ENOENT;
@@ -1290,10 +1706,10 @@ int amdxdna_drm_sync_bo_ioctl(struct drm_device *dev,
 
 	if (abo->assigned_ctx != AMDXDNA_INVALID_CTX_HANDLE &&
 	    args->direction == SYNC_DIRECT_FROM_DEVICE) {
-		u64 seq;
+		u32 hdl;
 
-		ctx_hdl = amdxdna_gem_get_assigned_ctx(client, args->handle);
-		if (ctx_hdl == AMDXDNA_INVALID_CTX_HANDLE ||
+		hdl = amdxdna_gem_get_assigned_ctx(client, args->handle);
+		if (hdl == AMDXDNA_INVALID_CTX_HANDLE ||
 		    args->direction != SYNC_DIRECT_FROM_DEVICE) {
 			XDNA_ERR(xdna, "Sync failed, dir %d", args->direction);
 			ret = -EINVAL;
@@ -1301,13 +1717,13 @@ int amdxdna_drm_sync_bo_ioctl(struct drm_device *dev,
 		}
 
 		ret = amdxdna_cmd_submit(client, OP_SYNC_BO, AMDXDNA_INVALID_BO_HANDLE,
-					 &args->handle, 1, NULL, NULL, 0, ctx_hdl, &seq);
+					 &args->handle, 1, AMDXDNA_INVALID_BO_LIST_HANDLE,
+					 NULL, NULL, 0, hdl, seq);
 		if (ret) {
 			XDNA_ERR(xdna, "Submit command failed");
 			goto put_obj;
 		}
-
-		ret = amdxdna_cmd_wait(client, ctx_hdl, seq, 3000 /* ms */);
+		*ctx_hdl = hdl;
 	}
 
 	XDNA_DBG(xdna, "Sync bo %d offset 0x%llx, size 0x%llx, dir %d, ctx %d",
@@ -1319,6 +1735,221 @@ put_obj:
 	return ret;
 }
 
+/*
+ * The sync bo ioctl is to make sure the CPU cache is in sync with memory.
+ * This is required because NPU is not cache coherent device. CPU cache
+ * flushing/invalidation is expensive so it is best to handle this outside
+ * of the command submission path. This ioctl allows explicit cache
+ * flushing/invalidation outside of the critical path.
+ */
+int amdxdna_drm_sync_bo_ioctl(struct drm_device *dev,
+			      void *data, struct drm_file *filp)
+{
+	struct amdxdna_client *client = filp->driver_priv;
+	struct amdxdna_drm_sync_bo *args = data;
+	u32 ctx_hdl;
+	u64 seq;
+	int ret;
+
+	ret = amdxdna_gem_sync_bo(client, args, &ctx_hdl, &seq);
+	if (ret || ctx_hdl == AMDXDNA_INVALID_CTX_HANDLE)
+		return ret;
+
+	return amdxdna_cmd_wait(client, ctx_hdl, seq, 3000 /* ms */);
+}
+
+/* Catch bad entries before anything of a SYNC_BOS request is submitted */
+static int amdxdna_gem_sync_bo_check(struct amdxdna_client *client,
+				     struct amdxdna_drm_sync_bo *args)
+{
+	struct drm_gem_object *gobj;
+	int ret = 0;
+
+	if (args->direction > SYNC_DIRECT_FROM_DEVICE)
+		return -EINVAL;
+
+	gobj = drm_gem_object_lookup(client->filp, args->handle);
+	if (!gobj)
+		return -ENOENT;
+
+	if (args->offset > gobj->size || args->size > gobj->size - args->offset)
+		ret = -EINVAL;
+
+	drm_gem_object_put(gobj);
+	return ret;
+}
+
+struct amdxdna_sync_seq {
+	u32	ctx_hdl;
+	u64	seq;
+};
+
+/*
+ * Commands of one context complete in order, only the last sequence number of
+ * each context has to be tracked.
+ */
+static void amdxdna_sync_seq_add(struct amdxdna_sync_seq *seqs, u32 *nr, u32 ctx_hdl, u64 seq)
+{
+	u32 i;
+
+	for (i = 0; i < *nr; i++) {
+		if (seqs[i].ctx_hdl == ctx_hdl) {
+			seqs[i].seq = max(seqs[i].seq, seq);
+			return;
+		}
+	}
+
+	seqs[*nr].ctx_hdl = ctx_hdl;
+	seqs[*nr].seq = seq;
+	(*nr)++;
+}
+
+static struct dma_fence *
+amdxdna_sync_seq_fence(struct amdxdna_client *client, struct amdxdna_sync_seq *seqs, u32 nr)
+{
+	struct dma_fence_array *array;
+	struct dma_fence **fences;
+	u32 i;
+
+	if (!nr)
+		return dma_fence_get_stub();
+	if (nr == 1)
+		return amdxdna_cmd_out_fence(client, seqs[0].ctx_hdl, seqs[0].seq);
+
+	fences = kcalloc(nr, sizeof(*fences), GFP_KERNEL);
+	if (!fences)
+		return NULL;
+
+	for (i = 0; i < nr; i++)
+		fences[i] = amdxdna_cmd_out_fence(client, seqs[i].ctx_hdl, seqs[i].seq);
+
+	/* The array owns fences on success */
+	array = dma_fence_array_create(nr, fences, dma_fence_context_alloc(1), 1, false);
+	if (!array) {
+		for (i = 0; i < nr; i++)
+			dma_fence_put(fences[i]);
+		kfree(fences);
+		return NULL;
+	}
+
+	return &array->base;
+}
+
+int amdxdna_drm_sync_bos_ioctl(struct drm_device *dev, void *data, struct drm_file *filp)
+{
+	struct amdxdna_client *client = filp->driver_priv;
+	struct amdxdna_dev *xdna = to_xdna_dev(dev);
+	struct amdxdna_drm_sync_bos *args = data;
+	struct dma_fence_chain *chain = NULL;
+	struct amdxdna_drm_sync_bo *entries;
+	struct drm_syncobj *syncobj = NULL;
+	struct amdxdna_sync_seq *seqs;
+	struct dma_fence *fence;
+	u32 nr_seqs = 0;
+	u32 ctx_hdl, i;
+	int ret, err = 0;
+	u64 seq;
+
+	if (args->ext || args->ext_flags || args->pad ||
+	    args->flags & ~AMDXDNA_SYNC_BOS_FLAG_ASYNC)
+		return -EINVAL;
+
+	if (!args->count || args->count > XDNA_MAX_SYNC_BO_COUNT) {
+		XDNA_ERR(xdna, "Invalid sync bo count %d", args->count);
+		return -EINVAL;
+	}
+
+	if (!(args->flags & AMDXDNA_SYNC_BOS_FLAG_ASYNC) && (args->syncobj || args->point))
+		return -EINVAL;
+
+	/* Fail async request before anything is submitted */
+	if (args->flags & AMDXDNA_SYNC_BOS_FLAG_ASYNC) {
+		syncobj = drm_syncobj_find(filp, args->syncobj);
+		if (!syncobj) {
+			XDNA_ERR(xdna, "Syncobj %d not found", args->syncobj);
+			return -ENOENT;
+		}
+
+		if (args->point) {
+			chain = dma_fence_chain_alloc();
+			if (!chain) {
+				ret = -ENOMEM;
+				goto put_syncobj;
+			}
+		}
+	}
+
+	entries = kvcalloc(args->count, sizeof(*entries) + sizeof(*seqs), GFP_KERNEL);
+	if (!entries) {
+		ret = -ENOMEM;
+		goto free_chain;
+	}
+	seqs = (struct amdxdna_sync_seq *)(entries + args->count);
+
+	if (copy_from_user(entries, u64_to_user_ptr(args->entries),
+			   args->count * sizeof(*entries))) {
+		ret = -EFAULT;
+		goto free_entries;
+	}
+
+	for (i = 0; i < args->count; i++) {
+		ret = amdxdna_gem_sync_bo_check(client, &entries[i]);
+		if (ret) {
+			XDNA_ERR(xdna, "Invalid sync bo entry %d, ret %d", i, ret);
+			goto free_entries;
+		}
+	}
+
+	/*
+	 * Submission can still fail part way. The syncs submitted by then are
+	 * waited for, or fenced in async mode, before the error is returned.
+	 */
+	for (i = 0; i < args->count; i++) {
+		err = amdxdna_gem_sync_bo(client, &entries[i], &ctx_hdl, &seq);
+		if (err) {
+			XDNA_ERR(xdna, "Sync bo entry %d failed, ret %d", i, err);
+			break;
+		}
+
+		if (ctx_hdl != AMDXDNA_INVALID_CTX_HANDLE)
+			amdxdna_sync_seq_add(seqs, &nr_seqs, ctx_hdl, seq);
+	}
+
+	if (!syncobj) {
+		for (i = 0; i < nr_seqs; i++) {
+			ret = amdxdna_cmd_wait(client, seqs[i].ctx_hdl, seqs[i].seq, 3000 /* ms */);
+			if (ret)
+				break;
+		}
+		ret = err ?: ret;
+		goto free_entries;
+	}
+
+	fence = amdxdna_sync_seq_fence(client, seqs, nr_seqs);
+	if (!fence) {
+		ret = -ENOMEM;
+		goto free_entries;
+	}
+
+	if (chain) {
+		drm_syncobj_add_point(syncobj, chain, fence, args->point);
+		chain = NULL;
+	} else {
+		drm_syncobj_replace_fence(syncobj, fence);
+	}
+	dma_fence_put(fence);
+	ret = err;
+
+free_entries:
+	kvfree(entries);
+free_chain:
+	dma_fence_chain_free(chain);
+put_syncobj:
+	if (syncobj)
+		drm_syncobj_put(syncobj);
+	return ret;
+}
+
 u32 amdxdna_gem_get_assigned_ctx(struct amdxdna_client *client, u32 bo_hdl)
 {
 	struct amdxdna_gem_obj *abo = amdxdna_gem_get_obj(client, bo_hdl, AMDXDNA_BO_INVALID);
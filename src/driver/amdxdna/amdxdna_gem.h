@@ -39,7 +39,25 @@ struct amdxdna_mem {
 #endif
 };
 
+struct amdxdna_heap_chunk {
+	struct list_head		entry;
+	struct drm_mm_node		node;
+};
+
+#define AMDXDNA_HEAP_CACHE_ORDERS	9 /* PAGE_SIZE up to 1MB */
+/*
+ * Per-CPU cache of free device heap chunks with power-of-two sizes. Cached
+ * chunks stay inserted in the heap drm_mm and are reused without mm_lock.
+ */
+struct amdxdna_heap_cache {
+	spinlock_t			lock; /* protect free lists, mostly uncontended */
+	struct list_head		free[AMDXDNA_HEAP_CACHE_ORDERS];
+	u32				cnt[AMDXDNA_HEAP_CACHE_ORDERS];
+};
+
 #define BO_SUBMIT_PINNED	BIT(0)
+#define BO_CLIENT_RESV		BIT(1) /* resv is the one of client's heap */
+#define BO_READ_ONLY		BIT(2) /* user can only map it read-only */
 struct amdxdna_gem_obj {
 	struct drm_gem_shmem_object	base;
 	struct amdxdna_client		*client;
@@ -50,7 +68,8 @@ struct amdxdna_gem_obj {
 
 	/* Below members are initialized when needed */
 	struct drm_mm			mm; /* For AMDXDNA_BO_DEV_HEAP */
-	struct drm_mm_node		mm_node; /* For AMDXDNA_BO_DEV / carvedout */
+	struct drm_mm_node		mm_node; /* For carvedout */
+	struct amdxdna_heap_chunk	*chunk; /* For AMDXDNA_BO_DEV */
 	u32				assigned_ctx; /* For debug bo */
 };
 
@@ -71,6 +90,9 @@ static inline void amdxdna_gem_put_obj(struct amdxdna_gem_obj *abo)
 
 void amdxdna_umap_put(struct amdxdna_umap *mapp);
 
+int amdxdna_gem_heap_cache_init(struct amdxdna_client *client);
+void amdxdna_gem_heap_cache_fini(struct amdxdna_client *client);
+
 struct drm_gem_object *
 amdxdna_gem_create_shmem_object_cb(struct drm_device *dev, size_t size);
 struct drm_gem_object *
@@ -78,6 +100,9 @@ amdxdna_gem_prime_import(struct drm_device *dev, struct dma_buf *dma_buf);
 struct amdxdna_gem_obj *
 amdxdna_drm_create_dev_bo(struct drm_device *dev, struct amdxdna_drm_create_bo *args,
 			  struct drm_file *filp);
+struct amdxdna_gem_obj *
+amdxdna_gem_create_ro_bo(struct amdxdna_client *client, size_t size);
+void amdxdna_gem_destroy_ro_bo(struct amdxdna_gem_obj *abo);
 
 int amdxdna_gem_pin_nolock(struct amdxdna_gem_obj *abo);
 int amdxdna_gem_pin(struct amdxdna_gem_obj *abo);
@@ -88,7 +113,9 @@ int amdxdna_gem_set_assigned_ctx(struct amdxdna_client *client, u32 bo_hdl, u32
 void amdxdna_gem_clear_assigned_ctx(struct amdxdna_client *client, u32 bo_hdl);
 
 int amdxdna_drm_create_bo_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
+int amdxdna_drm_create_bos_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 int amdxdna_drm_get_bo_info_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 int amdxdna_drm_sync_bo_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
+int amdxdna_drm_sync_bos_ioctl(struct drm_device *dev, void *data, struct drm_file *filp);
 
 #endif /* _AMDXDNA_GEM_H_ */
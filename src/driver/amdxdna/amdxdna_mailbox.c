@@ -18,6 +18,8 @@
 #if defined(CONFIG_DEBUG_FS)
 #include <linux/seq_file.h>
 #include <linux/wait.h>
+#include <linux/ktime.h>
+#include <linux/sizes.h>
 #endif
 #ifdef AMDXDNA_DEVEL
 #include <linux/kthread.h>
@@ -320,6 +322,36 @@ no_space:
 	return -ENOSPC;
 }
 
+void xdna_mailbox_memcpy_fromio(void *dst, const void __iomem *src, size_t size)
+{
+#ifdef CONFIG_64BIT
+	u64 val;
+
+	/* Ring offsets are word aligned; step up to a quadword boundary first */
+	if (size >= sizeof(u32) && !IS_ALIGNED((uintptr_t)src, sizeof(u64)) &&
+	    IS_ALIGNED((uintptr_t)src, sizeof(u32))) {
+		u32 word = __raw_readl(src);
+
+		memcpy(dst, &word, sizeof(word));
+		dst += sizeof(word);
+		src += sizeof(word);
+		size -= sizeof(word);
+	}
+
+	if (IS_ALIGNED((uintptr_t)src, sizeof(u64))) {
+		while (size >= sizeof(u64)) {
+			val = __raw_readq(src);
+			memcpy(dst, &val, sizeof(val));
+			dst += sizeof(val);
+			src += sizeof(val);
+			size -= sizeof(val);
+		}
+	}
+#endif
+	if (size)
+		memcpy_fromio(dst, src, size);
+}
+
 static int
 mailbox_get_resp(struct mailbox_channel *mb_chann, struct xdna_msg_header *header,
 		 void __iomem *data)
@@ -420,7 +452,7 @@ static int mailbox_get_msg(struct mailbox_channel *mb_chann)
 
 	rest = sizeof(header) - sizeof(u32);
 	read_addr += sizeof(u32);
-	memcpy_fromio((u32 *)&header + 1, read_addr, rest);
+	xdna_mailbox_memcpy_fromio((u32 *)&header + 1, read_addr, rest);
 	read_addr += rest;
 
 	ret = mailbox_get_resp(mb_chann, &header, read_addr);
@@ -803,6 +835,49 @@ int xdna_mailbox_ringbuf_show(struct mailbox *mb, struct seq_file *m)
 	vfree(buf);
 	return 0;
 }
+
+#define XDNA_COPY_BENCH_MAX_ITERS	100000
+
+int xdna_mailbox_copy_bench(struct mailbox *mb, u32 iters)
+{
+	size_t max_size = min_t(size_t, SZ_4K, mb->res.ringbuf_size);
+	u64 io_ns, raw_ns;
+	ktime_t start;
+	size_t size;
+	void *buf;
+	u32 i;
+
+	if (!iters || iters > XDNA_COPY_BENCH_MAX_ITERS) {
+		dev_err(mb->dev, "Invalid iters %u, 1 to %u", iters, XDNA_COPY_BENCH_MAX_ITERS);
+		return -EINVAL;
+	}
+	if (max_size < 16)
+		return -EINVAL;
+
+	buf = kmalloc(max_size, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	/* Read-only over the start of the ring area, so safe while channels run */
+	for (size = 16; size <= max_size; size <<= 1) {
+		start = ktime_get();
+		for (i = 0; i < iters; i++)
+			memcpy_fromio(buf, mb->res.ringbuf_base, size);
+		io_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		start = ktime_get();
+		for (i = 0; i < iters; i++)
+			xdna_mailbox_memcpy_fromio(buf, mb->res.ringbuf_base, size);
+		raw_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		dev_info(mb->dev, "copy %5zu bytes: memcpy_fromio %llu ns, mailbox copy %llu ns",
+			 size, div_u64(io_ns, iters), div_u64(raw_ns, iters));
+		cond_resched();
+	}
+
+	kfree(buf);
+	return 0;
+}
 #endif /* CONFIG_DEBUG_FS */
 
 struct mailbox_channel *
@@ -164,6 +164,18 @@ void xdna_mailbox_stop_channel(struct mailbox_channel *mailbox_chann);
 int xdna_mailbox_send_msg(struct mailbox_channel *mailbox_chann,
 			  struct xdna_mailbox_msg *msg, u64 tx_timeout);
 
+/*
+ * xdna_mailbox_memcpy_fromio() -- Copy a message out of the mailbox ring buffer
+ *
+ * @dst: destination buffer in system memory
+ * @src: source address in the ring buffer
+ * @size: number of bytes to copy
+ *
+ * Same as memcpy_fromio(), but uses the widest MMIO load the platform allows,
+ * since every read of the uncached ring is a round trip to the device.
+ */
+void xdna_mailbox_memcpy_fromio(void *dst, const void __iomem *src, size_t size);
+
 #if defined(CONFIG_DEBUG_FS)
 /*
  * xdna_mailbox_info_show() -- Show mailbox info for debug
@@ -186,6 +198,20 @@ int xdna_mailbox_info_show(struct mailbox *mailbox,
  */
 int xdna_mailbox_ringbuf_show(struct mailbox *mailbox,
 			      struct seq_file *m);
+
+/*
+ * xdna_mailbox_copy_bench() -- Time ring buffer copies for debug
+ *
+ * @mailbox: the handle return from xdna_mailbox_create()
+ * @iters: number of copies per response size, at most 100000
+ *
+ * Compares memcpy_fromio() with xdna_mailbox_memcpy_fromio() for sizes from
+ * 16 bytes to 4KB, or the ring buffer size if smaller, and logs the average
+ * time of each.
+ *
+ * Return: if success, return 0; otherwise return error code
+ */
+int xdna_mailbox_copy_bench(struct mailbox *mailbox, u32 iters);
 #endif
 
 #endif /* _AIE2_MAILBOX_ */
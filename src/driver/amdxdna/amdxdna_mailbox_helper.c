@@ -18,7 +18,7 @@ int xdna_msg_cb(void *handle, void __iomem *data, size_t size)
 		goto out;
 	}
 
-	memcpy_fromio(cb_arg->data, data, cb_arg->size);
+	xdna_mailbox_memcpy_fromio(cb_arg->data, data, cb_arg->size);
 	print_hex_dump_debug("resp data: ", DUMP_PREFIX_OFFSET,
 			     16, 4, cb_arg->data, cb_arg->size, true);
 out:
@@ -27,24 +27,52 @@ out:
 	return ret;
 }
 
-int xdna_send_msg_wait(struct amdxdna_dev *xdna, struct mailbox_channel *chann,
-		       struct xdna_mailbox_msg *msg)
+int xdna_send_msg(struct amdxdna_dev *xdna, struct mailbox_channel *chann,
+		  struct xdna_mailbox_msg *msg)
 {
-	struct xdna_notify *hdl = msg->handle;
 	int ret;
 
 	ret = xdna_mailbox_send_msg(chann, msg, TX_TIMEOUT);
-	if (ret) {
+	if (ret)
 		XDNA_ERR(xdna, "Send message failed, ret %d", ret);
-		return ret;
-	}
 
-	ret = wait_for_completion_timeout(&hdl->comp,
-					  msecs_to_jiffies(RX_TIMEOUT));
-	if (!ret) {
-		XDNA_ERR(xdna, "Wait for completion timeout");
-		return -ETIME;
+	return ret;
+}
+
+/*
+ * All messages share one RX_TIMEOUT. On -ETIME, some messages may still be
+ * pending and the caller has to destroy the channel before reusing them.
+ */
+int xdna_wait_msgs(struct amdxdna_dev *xdna, struct xdna_mailbox_msg **msgs, u32 cnt)
+{
+	unsigned long timeout = jiffies + msecs_to_jiffies(RX_TIMEOUT);
+	struct xdna_notify *hdl;
+	int ret = 0;
+	u32 i;
+
+	for (i = 0; i < cnt; i++) {
+		hdl = msgs[i]->handle;
+		if (!wait_for_completion_timeout(&hdl->comp,
+						 max_t(long, timeout - jiffies, 1))) {
+			XDNA_ERR(xdna, "Wait for completion timeout");
+			return -ETIME;
+		}
+
+		if (!ret)
+			ret = hdl->error;
 	}
 
-	return hdl->error;
+	return ret;
+}
+
+int xdna_send_msg_wait(struct amdxdna_dev *xdna, struct mailbox_channel *chann,
+		       struct xdna_mailbox_msg *msg)
+{
+	int ret;
+
+	ret = xdna_send_msg(xdna, chann, msg);
+	if (ret)
+		return ret;
+
+	return xdna_wait_msgs(xdna, &msg, 1);
 }
@@ -40,7 +40,32 @@ struct xdna_notify {
 #define XDNA_STATUS_OFFSET(name) (offsetof(struct name##_resp, status) / sizeof(u32))
 
 int xdna_msg_cb(void *handle, void __iomem *data, size_t size);
+
+/* Same as DECLARE_XDNA_MSG_COMMON() for messages not declared on stack */
+static inline void xdna_msg_init(struct xdna_mailbox_msg *msg, struct xdna_notify *hdl,
+				 u32 opcode, void *req, size_t req_size,
+				 void *resp, size_t resp_size)
+{
+	init_completion(&hdl->comp);
+	hdl->error = 0;
+	hdl->data = resp;
+	hdl->size = resp_size;
+
+	msg->send_data = req;
+	msg->send_size = req_size;
+	msg->handle = hdl;
+	msg->opcode = opcode;
+	msg->notify_cb = xdna_msg_cb;
+}
+
 int xdna_send_msg_wait(struct amdxdna_dev *xdna, struct mailbox_channel *chann,
 		       struct xdna_mailbox_msg *msg);
+/*
+ * Asynchronous version of xdna_send_msg_wait(). Messages sent by xdna_send_msg()
+ * are in flight together and xdna_wait_msgs() waits for all of them.
+ */
+int xdna_send_msg(struct amdxdna_dev *xdna, struct mailbox_channel *chann,
+		  struct xdna_mailbox_msg *msg);
+int xdna_wait_msgs(struct amdxdna_dev *xdna, struct xdna_mailbox_msg **msgs, u32 cnt);
 
 #endif /* _AMDXDNA_MAILBOX_HELPER_H */
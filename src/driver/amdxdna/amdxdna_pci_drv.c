@@ -103,9 +103,15 @@ static int amdxdna_probe(struct pci_dev *pdev, const struct pci_device_id *id)
 	if (!xdna->dev_info->ops->init || !xdna->dev_info->ops->fini)
 		return -EOPNOTSUPP;
 
+	ret = init_srcu_struct(&xdna->client_srcu);
+	if (ret)
+		return ret;
+
 	xdna->notifier_wq = alloc_ordered_workqueue("notifier_wq", 0);
-	if (!xdna->notifier_wq)
-		return -ENOMEM;
+	if (!xdna->notifier_wq) {
+		ret = -ENOMEM;
+		goto cleanup_srcu;
+	}
 
 	mutex_lock(&xdna->dev_lock);
 	ret = xdna->dev_info->ops->init(xdna);
@@ -170,6 +176,8 @@ failed_dev_fini:
 	mutex_unlock(&xdna->dev_lock);
 destroy_notifier_wq:
 	destroy_workqueue(xdna->notifier_wq);
+cleanup_srcu:
+	cleanup_srcu_struct(&xdna->client_srcu);
 	return ret;
 }
 
@@ -208,6 +216,7 @@ static void amdxdna_remove(struct pci_dev *pdev)
 
 	xdna->dev_info->ops->fini(xdna);
 	mutex_unlock(&xdna->dev_lock);
+	cleanup_srcu_struct(&xdna->client_srcu);
 #ifdef AMDXDNA_DEVEL
 	ida_destroy(&xdna->pdi_ida);
 #endif
@@ -305,14 +314,27 @@ static struct pci_driver amdxdna_pci_driver = {
 
 static int __init amdxdna_mod_init(void)
 {
+	int ret;
+
+	ret = amdxdna_ctx_caches_init();
+	if (ret)
+		return ret;
+
 	amdxdna_carvedout_init();
-	return pci_register_driver(&amdxdna_pci_driver);
+	ret = pci_register_driver(&amdxdna_pci_driver);
+	if (ret) {
+		amdxdna_carvedout_fini();
+		amdxdna_ctx_caches_fini();
+	}
+
+	return ret;
 }
 
 static void __exit amdxdna_mod_exit(void)
 {
 	pci_unregister_driver(&amdxdna_pci_driver);
 	amdxdna_carvedout_fini();
+	amdxdna_ctx_caches_fini();
 }
 
 module_init(amdxdna_mod_init);
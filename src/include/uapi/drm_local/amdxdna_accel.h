@@ -25,6 +25,7 @@ extern "C" {
 #define AMDXDNA_INVALID_CTX_HANDLE	0
 #define AMDXDNA_INVALID_BO_HANDLE	0
 #define AMDXDNA_INVALID_FENCE_HANDLE	0
+#define AMDXDNA_INVALID_BO_LIST_HANDLE	0
 
 #define POWER_MODE_DEFAULT	0
 #define POWER_MODE_LOW		1
@@ -57,6 +58,10 @@ extern "C" {
 #define	DRM_AMDXDNA_GET_INFO		7
 #define	DRM_AMDXDNA_SET_STATE		8
 #define	DRM_AMDXDNA_WAIT_CMD		9
+#define	DRM_AMDXDNA_CREATE_BO_LIST	10
+#define	DRM_AMDXDNA_DESTROY_BO_LIST	11
+#define	DRM_AMDXDNA_SYNC_BOS		12
+#define	DRM_AMDXDNA_CREATE_BOS		13
 
 #define	AMDXDNA_DEV_TYPE_UNKNOWN	-1
 #define	AMDXDNA_DEV_TYPE_KMQ		0
@@ -112,6 +117,11 @@ struct amdxdna_qos_info {
  * @umq_doorbell: Returned offset of doorbell associated with UMQ.
  * @handle: Returned context handle.
  * @syncobj_handle: The drm timeline syncobj handle for command completion notification.
+ * @completed_addr: Returned user VA, in device heap, of a __u64 counting completed
+ *                  commands. Command of sequence number lower than it is completed.
+ *                  0 if not supported.
+ * @status_offset: Returned mmap() offset of the context's struct amdxdna_ctx_status
+ *                 page, which can only be mapped read-only. 0 if not supported.
  */
 struct amdxdna_drm_create_ctx {
 	__u64 ext;
@@ -125,6 +135,32 @@ struct amdxdna_drm_create_ctx {
 	__u32 umq_doorbell;
 	__u32 handle;
 	__u32 syncobj_handle;
+	__u64 completed_addr;
+	__u64 status_offset;
+};
+
+/**
+ * struct amdxdna_ctx_status - Live counters of a context, shared with user.
+ * @completed: Number of completed commands. Command of sequence number lower
+ *             than it is completed.
+ * @seq: Odd while the driver updates the counters. To read a consistent
+ *       snapshot, read @seq, then the counters, then @seq again, and retry if
+ *       the first read was odd or the two reads differ.
+ * @pad: Reserved.
+ * @submitted: Number of submitted commands.
+ * @errors: Number of commands which failed to run or did not complete
+ *          successfully.
+ *
+ * The driver updates it on command submission, completion and failure. The
+ * page is owned by the driver and mapped read-only by user, the counters are
+ * the same as DRM_AMDXDNA_QUERY_HW_CONTEXTS reports.
+ */
+struct amdxdna_ctx_status {
+	__u64 completed;
+	__u32 seq;
+	__u32 pad;
+	__u64 submitted;
+	__u64 errors;
 };
 
 /**
@@ -172,12 +208,17 @@ struct amdxdna_ctx_param_config_cu {
  *
  * Note: if the param_val is a pointer pointing to a buffer, the maximum size
  * of the buffer is 4KiB(PAGE_SIZE).
+ *
+ * DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA takes the handle of an AMDXDNA_BO_DEV BO
+ * in param_val. See struct amdxdna_submit_area_hdr. A context has at most one
+ * submission area, which is released together with the context.
  */
 struct amdxdna_drm_config_ctx {
 	__u32 handle;
 #define DRM_AMDXDNA_CTX_CONFIG_CU	0
 #define	DRM_AMDXDNA_CTX_ASSIGN_DBG_BUF	1
 #define	DRM_AMDXDNA_CTX_REMOVE_DBG_BUF	2
+#define	DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA	3
 	__u32 param_type;
 	__u64 param_val;
 	__u32 param_val_size;
@@ -197,13 +238,22 @@ struct amdxdna_bo_va_entry {
 
 /**
  * struct amdxdna_drm_create_bo - Create a buffer object.
- * @flags: Buffer flags. MBZ.
+ * @flags: Buffer flags, AMDXDNA_BO_FLAG_*. Other bits MBZ.
  * @vaddr: User VA of buffer if applied. MBZ.
  * @size: Size in bytes.
  * @type: Buffer type.
  * @handle: Returned DRM buffer object handle.
  */
 struct amdxdna_drm_create_bo {
+/*
+ * Share the reservation object of the client's device heap instead of
+ * using a private one. Only valid for AMDXDNA_BO_DEV. Submissions then
+ * lock and fence all such BOs once, no matter how many are passed.
+ * Any wait on such a BO, e.g. SYNC_BO or freeing it, waits for every
+ * command of the client using any BO with this flag. Only set it for BOs
+ * that are never waited on individually.
+ */
+#define AMDXDNA_BO_FLAG_CLIENT_RESV	(1ULL << 0)
 	__u64	flags;
 	__u64	vaddr;
 	__u64	size;
@@ -238,6 +288,45 @@ struct amdxdna_drm_get_bo_info {
 	__u64 xdna_addr;
 };
 
+/**
+ * struct amdxdna_drm_create_bos_entry - One buffer object of CREATE_BOS.
+ * @flags: Buffer flags, same as amdxdna_drm_create_bo.
+ * @size: Size in bytes.
+ * @type: Buffer type. AMDXDNA_BO_SHARE, AMDXDNA_BO_DEV or AMDXDNA_BO_CMD.
+ * @handle: Returned DRM buffer object handle.
+ * @map_offset: Returned DRM fake offset for mmap().
+ * @vaddr: Returned user VA of buffer. 0 in case user needs mmap().
+ * @xdna_addr: Returned XDNA device virtual address.
+ */
+struct amdxdna_drm_create_bos_entry {
+	__u64	flags;
+	__u64	size;
+	__u32	type;
+	__u32	handle;
+	__u64	map_offset;
+	__u64	vaddr;
+	__u64	xdna_addr;
+};
+
+/**
+ * struct amdxdna_drm_create_bos - Create multiple buffer objects.
+ * @ext: MBZ.
+ * @ext_flags: MBZ.
+ * @entries: Array of struct amdxdna_drm_create_bos_entry, one per BO.
+ * @count: Number of entries in the entries array.
+ * @pad: Structure padding. MBZ.
+ *
+ * Same as CREATE_BO followed by GET_BO_INFO for each entry. Either all BOs
+ * are created or none of them is.
+ */
+struct amdxdna_drm_create_bos {
+	__u64 ext;
+	__u64 ext_flags;
+	__u64 entries;
+	__u32 count;
+	__u32 pad;
+};
+
 /**
  * struct amdxdna_drm_sync_bo - Sync buffer object.
  * @handle: Buffer object handle.
@@ -255,20 +344,156 @@ struct amdxdna_drm_sync_bo {
 };
 
 /**
- * struct amdxdna_drm_exec_cmd - Execute command.
+ * struct amdxdna_drm_sync_bos - Sync multiple buffer objects.
+ * @ext: MBZ.
+ * @ext_flags: MBZ.
+ * @entries: Array of struct amdxdna_drm_sync_bo, one per BO range.
+ * @count: Number of entries in the entries array.
+ * @flags: AMDXDNA_SYNC_BOS_FLAG_*. Other bits MBZ.
+ * @syncobj: With AMDXDNA_SYNC_BOS_FLAG_ASYNC, the syncobj handle signaled
+ *           when all the syncs from device are completed. Otherwise MBZ.
+ * @pad: Structure padding. MBZ.
+ * @point: Timeline point of syncobj to signal. 0 for binary syncobj.
+ *
+ * Same as SYNC_BO for each entry. Syncs from device of all BOs are submitted
+ * before any of them is waited for. In async mode, the ioctl returns once the
+ * syncs are submitted and syncobj tells their completion.
+ *
+ * All entries are validated before anything is done. If an entry still fails
+ * later, the entries before it have been synced. The ioctl waits for them, or
+ * in async mode signals syncobj when they are done, and then returns the
+ * error of the failed entry.
+ */
+struct amdxdna_drm_sync_bos {
+	__u64 ext;
+	__u64 ext_flags;
+	__u64 entries;
+	__u32 count;
+#define AMDXDNA_SYNC_BOS_FLAG_ASYNC	(1U << 0)
+	__u32 flags;
+	__u32 syncobj;
+	__u32 pad;
+	__u64 point;
+};
+
+/**
+ * struct amdxdna_drm_create_bo_list - Create a pre-validated BO list.
  * @ext: MBZ.
  * @ext_flags: MBZ.
+ * @handles: Address of an array of BO handles.
+ * @count: Number of BO handles in the handles array.
+ * @handle: Returned BO list handle.
+ *
+ * Driver looks up and pins every BO once and holds a reference on it until the
+ * BO list is destroyed. An AMDXDNA_CMD_SUBMIT_EXEC_BUF command can name the BO
+ * list instead of passing an argument handle array, see
+ * AMDXDNA_EXEC_FLAG_BO_LIST.
+ *
+ * Closing the handle of a BO in the list does not free or unpin the BO. Its
+ * memory stays allocated until the BO list is destroyed as well, so user space
+ * should destroy a BO list before, or together with, its BOs.
+ */
+struct amdxdna_drm_create_bo_list {
+	__u64 ext;
+	__u64 ext_flags;
+	__u64 handles;
+	__u32 count;
+	__u32 handle;
+};
+
+/**
+ * struct amdxdna_drm_destroy_bo_list - Destroy a BO list.
+ * @handle: BO list handle.
+ * @pad: Structure padding.
+ *
+ * Commands already submitted with this BO list keep the BOs alive until they
+ * are completed.
+ */
+struct amdxdna_drm_destroy_bo_list {
+	__u32 handle;
+	__u32 pad;
+};
+
+/**
+ * struct amdxdna_drm_exec_syncobjs - Syncobjs attached to a command.
+ * @in_handles: Array of syncobj handles the command depends on.
+ * @in_points: Array of timeline points, one per in_handles entry.
+ *             0 for binary syncobj.
+ * @in_count: Number of entries in the in_handles and in_points arrays.
+ * @out_count: Number of entries in the out_handles and out_points arrays.
+ * @out_handles: Array of syncobj handles signaled by the command.
+ * @out_points: Array of timeline points, one per out_handles entry.
+ *              0 for binary syncobj.
+ *
+ * The command is not scheduled before all the in-fences are signaled. The
+ * fences must already be submitted, i.e. be available, at the time of the
+ * EXEC_CMD ioctl. The completion fence of the command is added to all the
+ * out points, as a following AMDXDNA_CMD_SUBMIT_SIGNAL would do.
+ */
+struct amdxdna_drm_exec_syncobjs {
+	__u64 in_handles;
+	__u64 in_points;
+	__u32 in_count;
+	__u32 out_count;
+	__u64 out_handles;
+	__u64 out_points;
+};
+
+/**
+ * struct amdxdna_submit_area_hdr - Header of a context submission area.
+ * @generation: Generation of the arrays currently written in the area.
+ * @pad: MBZ.
+ *
+ * A submission area is a device BO registered to a context through
+ * DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA. With AMDXDNA_EXEC_FLAG_SUBMIT_AREA, the
+ * argument and in-syncobj arrays of a submission are passed as byte offsets
+ * into the area instead of user pointers. The driver reads them through its
+ * own mapping of the area, fetching each element once.
+ * User bumps @generation after writing the arrays and passes the same value
+ * in struct amdxdna_drm_exec_cmd seq. The submission fails with -ESTALE if
+ * they differ. The arrays must not be changed until EXEC_CMD returns.
+ *
+ * The arrays follow the header and must be naturally aligned.
+ */
+struct amdxdna_submit_area_hdr {
+	__u64 generation;
+	__u64 pad;
+};
+
+/**
+ * struct amdxdna_drm_exec_cmd - Execute command.
+ * @ext: Pointer to struct amdxdna_drm_exec_syncobjs with
+ *       AMDXDNA_EXEC_FLAG_SYNCOBJS. Otherwise MBZ.
+ * @ext_flags: Submission flags, AMDXDNA_EXEC_FLAG_*. Other bits MBZ.
  * @ctx: Context handle.
  * @type: Command type.
  * @cmd_handles: Array of command handles or the command handle itself
  *               in case of just one.
- * @args: Array of arguments for all command handles.
+ * @args: Array of arguments for all command handles. With
+ *        AMDXDNA_EXEC_FLAG_BO_LIST, the BO list handle itself.
  * @cmd_count: Number of command handles in the cmd_handles array.
- * @arg_count: Number of arguments in the args array.
- * @seq: Returned sequence number for this command.
+ * @arg_count: Number of arguments in the args array. MBZ with
+ *             AMDXDNA_EXEC_FLAG_BO_LIST.
+ * @seq: Returned sequence number for this command. With
+ *       AMDXDNA_EXEC_FLAG_SUBMIT_AREA, the area generation on input.
+ *
+ * For AMDXDNA_CMD_SUBMIT_DEPENDENCY and AMDXDNA_CMD_SUBMIT_SIGNAL, cmd_handles
+ * and args are arrays of syncobj handles and points. A single signal syncobj
+ * handle and point are passed by value.
+ *
+ * With AMDXDNA_EXEC_FLAG_SUBMIT_AREA, args of AMDXDNA_CMD_SUBMIT_EXEC_BUF,
+ * the in_handles and in_points of struct amdxdna_drm_exec_syncobjs, and
+ * cmd_handles and args of AMDXDNA_CMD_SUBMIT_DEPENDENCY are offsets into the
+ * submission area of the context.
  */
 struct amdxdna_drm_exec_cmd {
 	__u64 ext;
+/* Argument BOs are given by a BO list handle in args */
+#define	AMDXDNA_EXEC_FLAG_BO_LIST	(1ULL << 0)
+/* Syncobjs to depend on or signal are given by a struct amdxdna_drm_exec_syncobjs in ext */
+#define	AMDXDNA_EXEC_FLAG_SYNCOBJS	(1ULL << 1)
+/* Arrays are read from the submission area of the context, see struct amdxdna_submit_area_hdr */
+#define	AMDXDNA_EXEC_FLAG_SUBMIT_AREA	(1ULL << 2)
 	__u64 ext_flags;
 	__u32 ctx;
 #define	AMDXDNA_CMD_SUBMIT_EXEC_BUF	0
@@ -506,6 +731,29 @@ struct amdxdna_drm_get_force_preempt_state {
 	__u8 pad[7];
 };
 
+/**
+ * struct amdxdna_drm_query_client_usage - NPU time usage of a single client.
+ * @pid: The Process ID of the process that opened the client.
+ * @busy_ns: Total NPU busy time of the client since it was opened.
+ * @period_ns: Length of the budget accounting period.
+ * @period_busy_ns: NPU busy time charged to the client in the current period.
+ *                  Always 0 for a client without budget.
+ * @allotted_ns: NPU time the client may use per period. 0 means unlimited.
+ * @throttled_ns: Total time submissions of the client waited for budget.
+ * @budget_pct: Budget of the client as a percentage of the period. 0 means unlimited.
+ * @pad: Structure padding.
+ */
+struct amdxdna_drm_query_client_usage {
+	__s64 pid;
+	__u64 busy_ns;
+	__u64 period_ns;
+	__u64 period_busy_ns;
+	__u64 allotted_ns;
+	__u64 throttled_ns;
+	__u32 budget_pct;
+	__u32 pad;
+};
+
 /**
  * struct amdxdna_drm_get_info - Get some information from the AIE hardware.
  * @param: Specifies the structure passed in the buffer.
@@ -525,6 +773,7 @@ struct amdxdna_drm_get_info {
 #define	DRM_AMDXDNA_GET_POWER_MODE		9
 #define	DRM_AMDXDNA_QUERY_TELEMETRY		10
 #define	DRM_AMDXDNA_GET_FORCE_PREEMPT_STATE	11
+#define	DRM_AMDXDNA_QUERY_CLIENT_USAGE		12
 	__u32 param; /* in */
 	__u32 buffer_size; /* in/out */
 	__u64 buffer; /* in/out */
@@ -551,6 +800,21 @@ struct amdxdna_drm_set_force_preempt_state {
 	__u8 pad[7];
 };
 
+/**
+ * struct amdxdna_drm_set_client_budget - Set the NPU time budget of a process
+ * @pid: The Process ID whose clients get the budget.
+ * @budget_pct: Percentage of each budget period the clients may keep the NPU
+ *              busy, 1 to 100. 0 removes the budget.
+ * @pad: MBZ.
+ *
+ * Submissions from a client that used up its budget wait for the next period.
+ */
+struct amdxdna_drm_set_client_budget {
+	__s64 pid;
+	__u32 budget_pct;
+	__u32 pad;
+};
+
 /**
  * struct amdxdna_drm_set_state - Set the state of some component within the AIE hardware.
  * @param: Specifies the structure passed in the buffer.
@@ -562,6 +826,7 @@ struct amdxdna_drm_set_state {
 #define	DRM_AMDXDNA_WRITE_AIE_MEM		1
 #define	DRM_AMDXDNA_WRITE_AIE_REG		2
 #define	DRM_AMDXDNA_SET_FORCE_PREEMPT		3
+#define	DRM_AMDXDNA_SET_CLIENT_BUDGET		4
 	__u32 param; /* in */
 	__u32 buffer_size; /* in */
 	__u64 buffer; /* in */
@@ -607,6 +872,22 @@ struct amdxdna_drm_set_state {
 	DRM_IOWR(DRM_COMMAND_BASE + DRM_AMDXDNA_SET_STATE, \
 		 struct amdxdna_drm_set_state)
 
+#define DRM_IOCTL_AMDXDNA_CREATE_BO_LIST \
+	DRM_IOWR(DRM_COMMAND_BASE + DRM_AMDXDNA_CREATE_BO_LIST, \
+		 struct amdxdna_drm_create_bo_list)
+
+#define DRM_IOCTL_AMDXDNA_DESTROY_BO_LIST \
+	DRM_IOWR(DRM_COMMAND_BASE + DRM_AMDXDNA_DESTROY_BO_LIST, \
+		 struct amdxdna_drm_destroy_bo_list)
+
+#define DRM_IOCTL_AMDXDNA_SYNC_BOS \
+	DRM_IOWR(DRM_COMMAND_BASE + DRM_AMDXDNA_SYNC_BOS, \
+		 struct amdxdna_drm_sync_bos)
+
+#define DRM_IOCTL_AMDXDNA_CREATE_BOS \
+	DRM_IOWR(DRM_COMMAND_BASE + DRM_AMDXDNA_CREATE_BOS, \
+		 struct amdxdna_drm_create_bos)
+
 #if defined(__cplusplus)
 } /* extern c end */
 #endif
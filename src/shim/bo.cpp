@@ -3,6 +3,8 @@
 
 #include "bo.h"
 #include "shim_debug.h"
+#include "trace_ring.h"
+#include "core/common/config_reader.h"
 #include <unistd.h>
 
 namespace {
@@ -17,6 +19,15 @@ map_parent_range(size_t size)
   return p;
 }
 
+// Replace a mapping with an inaccessible one, keeping the address range taken
+void
+reserve_range(void *addr, size_t size)
+{
+  auto p = ::mmap(addr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  if (p == MAP_FAILED)
+    shim_err(errno, "mmap(addr=%p, len=%ld) failed", addr, size);
+}
+
 void*
 map_drm_bo(const shim_xdna::pdev& dev, void *addr, size_t size, int prot, int flags, uint64_t offset)
 {
@@ -74,6 +85,18 @@ import_drm_bo(const shim_xdna::pdev& dev, const shim_xdna::shared& share,
   return imp_bo.handle;
 }
 
+bool
+is_client_resv()
+{
+  static int client_resv = -1;
+
+  if (client_resv == -1) {
+    bool cr = xrt_core::config::detail::get_bool_value("Debug.xdna_client_resv", false);
+    client_resv = cr ? 1 : 0;
+  }
+  return client_resv == 1;
+}
+
 bool
 is_power_of_two(size_t x)
 {
@@ -101,6 +124,7 @@ drm_bo(bo& parent, const amdxdna_drm_get_bo_info& bo_info)
   , m_vaddr(bo_info.vaddr)
   , m_xdna_addr(bo_info.xdna_addr)
 {
+  trace::log(trace::event::bo_alloc, m_handle, m_parent.m_type, m_parent.m_aligned_size);
 }
 
 bo::drm_bo::
@@ -108,6 +132,7 @@ bo::drm_bo::
 {
   if (m_handle == AMDXDNA_INVALID_BO_HANDLE)
     return;
+  trace::log(trace::event::bo_free, m_handle);
   try {
     m_parent.free_drm_bo(m_parent.m_pdev, m_handle);
   } catch (const xrt_core::system_error& e) {
@@ -178,6 +203,29 @@ mmap_bo(size_t align)
     MAP_SHARED | MAP_LOCKED | MAP_FIXED, m_bo->m_map_offset);
 }
 
+void
+bo::
+mmap_bo_at(const std::shared_ptr<char>& range, size_t offset)
+{
+  if (!range || m_bo->m_map_offset == AMDXDNA_INVALID_ADDR) {
+    mmap_bo();
+    return;
+  }
+
+  m_aligned = map_drm_bo(m_pdev, range.get() + offset, m_aligned_size, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_LOCKED | MAP_FIXED, m_bo->m_map_offset);
+  m_range = range;
+}
+
+std::shared_ptr<char>
+bo::
+map_shared_range(size_t size)
+{
+  auto p = static_cast<char *>(map_parent_range(size));
+  // Anonymous reservation, BOs mapped in it are already gone when it is freed
+  return std::shared_ptr<char>(p, [size](char *p) { ::munmap(p, size); });
+}
+
 void
 bo::
 munmap_bo()
@@ -186,6 +234,14 @@ munmap_bo()
   if (m_bo->m_map_offset == AMDXDNA_INVALID_ADDR)
       return;
 
+  if (m_range) {
+    // Drop the BO mapping but keep its slot reserved until the range goes,
+    // so nothing else gets mapped between BOs still in use
+    reserve_range(m_aligned, m_aligned_size);
+    m_range.reset();
+    return;
+  }
+
   unmap_drm_bo(m_pdev, m_aligned, m_aligned_size);
   if (m_parent)
       unmap_drm_bo(m_pdev, m_parent, m_parent_size);
@@ -202,6 +258,19 @@ alloc_bo()
   m_bo = std::make_unique<bo::drm_bo>(*this, bo_info);
 }
 
+void
+bo::
+alloc_bo(const amdxdna_drm_create_bos_entry& entry)
+{
+  amdxdna_drm_get_bo_info bo_info = {
+    .handle = entry.handle,
+    .map_offset = entry.map_offset,
+    .vaddr = entry.vaddr,
+    .xdna_addr = entry.xdna_addr,
+  };
+  m_bo = std::make_unique<bo::drm_bo>(*this, bo_info);
+}
+
 void
 bo::
 import_bo()
@@ -337,11 +406,25 @@ get_type() const
   return m_type;
 }
 
+uint64_t
+bo::
+drm_bo_flags(int type)
+{
+  // With a shared reservation object, submission cost does not grow with the
+  // number of arguments. But waiting on one such BO, e.g. for sync or free,
+  // waits for every command of the process using any of them, so only do it
+  // when asked to.
+  if (type == AMDXDNA_BO_DEV && is_client_resv())
+    return AMDXDNA_BO_FLAG_CLIENT_RESV;
+  return 0;
+}
+
 uint32_t
 bo::
 alloc_drm_bo(const shim_xdna::pdev& dev, int type, size_t size)
 {
   amdxdna_drm_create_bo cbo = {
+    .flags = drm_bo_flags(type),
     .vaddr = 0,
     .size = size,
     .type = static_cast<uint32_t>(type),
@@ -89,6 +89,10 @@ protected:
   void
   alloc_bo();
 
+  // Take over DRM BO which is created in a batch
+  void
+  alloc_bo(const amdxdna_drm_create_bos_entry& entry);
+
   // Import DRM BO from m_import shared object
   void
   import_bo();
@@ -103,6 +107,18 @@ protected:
   void
   munmap_bo();
 
+  // Map BO at offset of a range reserved by map_shared_range(). The range is
+  // only unmapped when all BOs mapped in it are freed.
+  void
+  mmap_bo_at(const std::shared_ptr<char>& range, size_t offset);
+
+  static std::shared_ptr<char>
+  map_shared_range(size_t size);
+
+  // AMDXDNA_BO_FLAG_* to pass to driver when creating a BO of given type
+  static uint64_t
+  drm_bo_flags(int type);
+
   uint64_t
   get_paddr() const;
 
@@ -142,6 +158,7 @@ private:
   const shared m_import;
   void* m_parent = nullptr;
   size_t m_parent_size = 0;
+  std::shared_ptr<char> m_range;
   // Command ID in the queue after command submission.
   // Only valid for cmd BO.
   uint64_t m_cmd_id = -1;
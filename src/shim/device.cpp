@@ -28,13 +28,19 @@ get_pcidev(const xrt_core::device* device)
   return pdev;
 }
 
-inline const shim_xdna::pdev&
-get_pcidev_impl(const xrt_core::device* device)
+inline const shim_xdna::device&
+get_device_impl(const xrt_core::device* device)
 {
   auto device_impl = dynamic_cast<const shim_xdna::device*>(device);
   if (!device_impl)
     throw xrt_core::error("Invalid device handle");
-  return device_impl->get_pdev();
+  return *device_impl;
+}
+
+inline const shim_xdna::pdev&
+get_pcidev_impl(const xrt_core::device* device)
+{
+  return get_device_impl(device).get_pdev();
 }
 
 template <typename ValueType>
@@ -110,42 +116,28 @@ struct aie_info
   {
     switch (key) {
     case key_type::aie_status_version:
-    {
-      amdxdna_drm_query_aie_version aie_version = {
-        .major = 0,
-        .minor = 0,
-      };
+      return get_device_impl(device).get_cached_query(key, [device] {
+        amdxdna_drm_query_aie_version aie_version = {
+          .major = 0,
+          .minor = 0,
+        };
 
-      amdxdna_drm_get_info arg = {
-        .param = DRM_AMDXDNA_QUERY_AIE_VERSION,
-        .buffer_size = sizeof(aie_version),
-        .buffer = reinterpret_cast<uintptr_t>(&aie_version)
-      };
+        amdxdna_drm_get_info arg = {
+          .param = DRM_AMDXDNA_QUERY_AIE_VERSION,
+          .buffer_size = sizeof(aie_version),
+          .buffer = reinterpret_cast<uintptr_t>(&aie_version)
+        };
 
-      auto& pci_dev_impl = get_pcidev_impl(device);
-      pci_dev_impl.ioctl(DRM_IOCTL_AMDXDNA_GET_INFO, &arg);
+        auto& pci_dev_impl = get_pcidev_impl(device);
+        pci_dev_impl.ioctl(DRM_IOCTL_AMDXDNA_GET_INFO, &arg);
 
-      query::aie_status_version::result_type output;
-      output.major = aie_version.major;
-      output.minor = aie_version.minor;
-      return output;
-    }
+        query::aie_status_version::result_type output;
+        output.major = aie_version.major;
+        output.minor = aie_version.minor;
+        return std::any(output);
+      });
     case key_type::aie_tiles_stats:
-    {
-      static std::map<const xrt_core::device *, query::aie_tiles_stats::result_type> cache;
-
-      auto iter = cache.find(device);
-      if (iter != cache.end())
-        return cache.at(device);
-
-      {
-        static std::mutex lock; // Usually there is only one device was referenced, not per device lock..
-        std::lock_guard L(lock);
-
-        auto iter = cache.find(device);
-        if (iter != cache.end())
-          return cache.at(device);
-
+      return get_device_impl(device).get_cached_query(key, [device] {
         amdxdna_drm_query_aie_metadata aie_metadata = {};
 
         amdxdna_drm_get_info arg = {
@@ -181,11 +173,8 @@ struct aie_info
         output.shim_dma_channels = aie_metadata.shim.dma_channel_count;
         output.shim_locks = aie_metadata.shim.lock_count;
         output.shim_events = aie_metadata.shim.event_reg_count;
-
-        cache.emplace(device, output);
-        return output;
-      }
-    }
+        return std::any(output);
+      });
     default:
       throw xrt_core::query::no_such_key(key, "Not implemented");
     }
@@ -631,25 +620,28 @@ struct firmware_version
   using result_type = query::firmware_version::result_type;
 
   static result_type
-  get(const xrt_core::device* device, key_type)
+  get(const xrt_core::device* device, key_type key)
   {
-    amdxdna_drm_query_firmware_version fw_version{};
+    auto cached = get_device_impl(device).get_cached_query(key, [device] {
+      amdxdna_drm_query_firmware_version fw_version{};
 
-    amdxdna_drm_get_info arg = {
-      .param = DRM_AMDXDNA_QUERY_FIRMWARE_VERSION,
-      .buffer_size = sizeof(fw_version),
-      .buffer = reinterpret_cast<uintptr_t>(&fw_version)
-    };
+      amdxdna_drm_get_info arg = {
+        .param = DRM_AMDXDNA_QUERY_FIRMWARE_VERSION,
+        .buffer_size = sizeof(fw_version),
+        .buffer = reinterpret_cast<uintptr_t>(&fw_version)
+      };
 
-    auto& pci_dev_impl = get_pcidev_impl(device);
-    pci_dev_impl.ioctl(DRM_IOCTL_AMDXDNA_GET_INFO, &arg);
+      auto& pci_dev_impl = get_pcidev_impl(device);
+      pci_dev_impl.ioctl(DRM_IOCTL_AMDXDNA_GET_INFO, &arg);
 
-    result_type output;
-    output.major = fw_version.major;
-    output.minor = fw_version.minor;
-    output.patch = fw_version.patch;
-    output.build = fw_version.build;
-    return output;
+      result_type output;
+      output.major = fw_version.major;
+      output.minor = fw_version.minor;
+      output.patch = fw_version.patch;
+      output.build = fw_version.build;
+      return std::any(output);
+    });
+    return std::any_cast<result_type>(cached);
   }
 };
 
@@ -1158,6 +1150,20 @@ get_pdev() const
   return m_pdev;
 }
 
+std::any
+device::
+get_cached_query(query::key_type key, const std::function<std::any()>& fetch) const
+{
+  std::lock_guard lk(m_query_cache_lock);
+  auto it = m_query_cache.find(key);
+  if (it != m_query_cache.end())
+    return it->second;
+
+  auto result = fetch();
+  m_query_cache.emplace(key, result);
+  return result;
+}
+
 void
 device::
 close_device()
@@ -1201,6 +1207,16 @@ alloc_bo(void* userptr, size_t size, uint64_t flags)
   return alloc_bo(userptr, AMDXDNA_INVALID_CTX_HANDLE, size, flags);
 }
 
+std::vector<std::unique_ptr<xrt_core::buffer_handle>>
+device::
+alloc_bos(const std::vector<size_t>& sizes, uint64_t flags)
+{
+  std::vector<std::unique_ptr<xrt_core::buffer_handle>> bos;
+  for (auto size : sizes)
+    bos.push_back(alloc_bo(nullptr, AMDXDNA_INVALID_CTX_HANDLE, size, flags));
+  return bos;
+}
+
 std::unique_ptr<xrt_core::buffer_handle>
 device::
 import_bo(pid_t pid, xrt_core::shared_handle::export_handle ehdl)
@@ -10,6 +10,11 @@
 
 #include "core/common/ishim.h"
 
+#include <any>
+#include <functional>
+#include <mutex>
+#include <vector>
+
 namespace shim_xdna {
 
 class device : public xrt_core::noshim<xrt_core::device_pcie>
@@ -23,6 +28,10 @@ private:
 
   std::map<uint32_t, xrt_core::buffer_handle *> m_bo_map;
 
+  // Query results that stay the same until the driver reloads firmware
+  mutable std::mutex m_query_cache_lock;
+  mutable std::map<xrt_core::query::key_type, std::any> m_query_cache;
+
   virtual std::unique_ptr<xrt_core::hwctx_handle>
   create_hw_context(const device& dev,
     const xrt::xclbin& xclbin, const xrt::hw_context::qos_type& qos) const = 0;
@@ -38,10 +47,18 @@ public:
   const pdev&
   get_pdev() const;
 
+  // Return the cached result of query key, calling fetch on first use
+  std::any
+  get_cached_query(xrt_core::query::key_type key, const std::function<std::any()>& fetch) const;
+
   virtual std::unique_ptr<xrt_core::buffer_handle>
   alloc_bo(void* userptr, xrt_core::hwctx_handle::slot_id ctx_id,
     size_t size, uint64_t flags) = 0;
 
+  // Allocate BOs shared by all HW contexts in one go, one by one by default
+  virtual std::vector<std::unique_ptr<xrt_core::buffer_handle>>
+  alloc_bos(const std::vector<size_t>& sizes, uint64_t flags);
+
 // ISHIM APIs supported are listed below
 public:
   void
@@ -269,6 +269,45 @@ submit_signal(const hw_ctx *ctx) const
   submit_signal_syncobj(m_pdev, ctx, m_syncobj_hdl, st);
 }
 
+std::pair<uint32_t, uint64_t>
+fence::
+next_wait_point() const
+{
+  auto st = signal_next_state();
+  shim_debug("Adding dependency on command fence %d@%ld", m_syncobj_hdl, st);
+  return { m_syncobj_hdl, st };
+}
+
+void
+fence::
+next_wait_points(const std::vector<xrt_core::fence_handle*>& fences,
+  std::vector<uint32_t>& hdls, std::vector<uint64_t>& pts)
+{
+  for (auto f : fences) {
+    auto fh = static_cast<const fence*>(f);
+    auto st = fh->wait_next_state();
+    shim_debug("Adding dependency on command fence %d@%ld", fh->m_syncobj_hdl, st);
+    hdls.push_back(fh->m_syncobj_hdl);
+    pts.push_back(st);
+  }
+}
+
+void
+fence::
+wait_available(const pdev& dev, const std::vector<uint32_t>& hdls,
+  const std::vector<uint64_t>& pts)
+{
+  wait_syncobj_available(dev, hdls.data(), pts.data(), static_cast<uint32_t>(hdls.size()));
+}
+
+void
+fence::
+submit_wait(const pdev& dev, const hw_ctx *ctx, const std::vector<uint32_t>& hdls,
+  const std::vector<uint64_t>& pts)
+{
+  submit_wait_syncobjs(dev, ctx, hdls.data(), pts.data(), static_cast<uint32_t>(hdls.size()));
+}
+
 void
 fence::
 submit_wait(const pdev& dev, const hw_ctx *ctx, const std::vector<xrt_core::fence_handle*>& fences)
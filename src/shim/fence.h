@@ -50,6 +50,25 @@ public:
   void
   submit_signal(const hw_ctx*) const;
 
+  // Syncobj handle and point for the next command to depend on, the wait
+  // itself is left to the caller
+  std::pair<uint32_t, uint64_t>
+  next_wait_point() const;
+
+  static void
+  next_wait_points(const std::vector<xrt_core::fence_handle*>& fences,
+    std::vector<uint32_t>& hdls, std::vector<uint64_t>& pts);
+
+  // Block until all points are submitted so that they can be depended on
+  static void
+  wait_available(const pdev& dev, const std::vector<uint32_t>& hdls,
+    const std::vector<uint64_t>& pts);
+
+  // Depend on points by a standalone dependency submission
+  static void
+  submit_wait(const pdev& dev, const hw_ctx*, const std::vector<uint32_t>& hdls,
+    const std::vector<uint64_t>& pts);
+
 private:
   uint64_t
   wait_next_state() const;
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+#include "device_group.h"
+#include "../shim_debug.h"
+
+#include "core/common/query_requests.h"
+#include "core/common/system.h"
+
+#include <algorithm>
+
+namespace {
+
+using device_load = shim_xdna::device_group::device_load;
+
+device_load
+query_load(xrt_core::device* dev)
+{
+  device_load load = {};
+
+  load.id = dev->get_device_id();
+  load.total_cols = xrt_core::device_query<xrt_core::query::aie_tiles_stats>(dev).cols;
+
+  // Contexts time sharing a partition report the same columns, count them once
+  std::vector<bool> busy(load.total_cols, false);
+  auto ctxs = xrt_core::device_query<xrt_core::query::aie_partition_info>(dev);
+  for (const auto& ctx : ctxs) {
+    for (uint64_t c = ctx.start_col; c < ctx.start_col + ctx.num_cols && c < busy.size(); c++)
+      busy[c] = true;
+    load.queued += ctx.command_submissions - ctx.command_completions;
+  }
+  load.busy_cols = static_cast<uint32_t>(std::count(busy.begin(), busy.end(), true));
+  load.contexts = static_cast<uint32_t>(ctxs.size());
+  return load;
+}
+
+// True if a is a better place for a new context than b
+bool
+less_loaded(const device_load& a, const device_load& b)
+{
+  auto a_free = a.total_cols - a.busy_cols;
+  auto b_free = b.total_cols - b.busy_cols;
+
+  if (a_free != b_free)
+    return a_free > b_free;
+  if (a.queued != b.queued)
+    return a.queued < b.queued;
+  return a.contexts < b.contexts;
+}
+
+}
+
+namespace shim_xdna {
+
+device_group::
+device_group(std::vector<std::shared_ptr<xrt_core::device>> devices)
+  : m_devices(std::move(devices))
+{
+  if (m_devices.empty())
+    shim_err(EINVAL, "Device group has no device");
+}
+
+device_group
+device_group::
+all()
+{
+  std::vector<std::shared_ptr<xrt_core::device>> devices;
+  auto total = xrt_core::get_total_devices(true).first;
+
+  for (xrt_core::device::id_type i = 0; i < total; i++) {
+    auto dev = xrt_core::get_userpf_device(i);
+    try {
+      query_load(dev.get());
+    } catch (const xrt_core::query::exception&) {
+      // Not an NPU
+      continue;
+    }
+    devices.push_back(std::move(dev));
+  }
+  return device_group(std::move(devices));
+}
+
+std::vector<device_group::device_load>
+device_group::
+get_load() const
+{
+  std::vector<device_load> loads;
+
+  for (auto& dev : m_devices)
+    loads.push_back(query_load(dev.get()));
+  return loads;
+}
+
+std::pair<std::shared_ptr<xrt_core::device>, std::unique_ptr<xrt_core::hwctx_handle>>
+device_group::
+create_hw_context(const xrt::xclbin& xclbin, const xrt::hw_context::qos_type& qos,
+  xrt::hw_context::access_mode mode)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+  std::vector<std::pair<device_load, std::shared_ptr<xrt_core::device>>> order;
+
+  for (auto& dev : m_devices)
+    order.emplace_back(query_load(dev.get()), dev);
+  std::stable_sort(order.begin(), order.end(),
+    [](const auto& a, const auto& b) { return less_loaded(a.first, b.first); });
+
+  for (size_t i = 0; i < order.size(); i++) {
+    auto& [load, dev] = order[i];
+    try {
+      dev->record_xclbin(xclbin);
+      auto ctx = dev->create_hw_context(xclbin.get_uuid(), qos, mode);
+      shim_debug("Group picked device %u: %u/%u cols busy, %u ctx, %lu queued",
+        load.id, load.busy_cols, load.total_cols, load.contexts, load.queued);
+      return { dev, std::move(ctx) };
+    } catch (const xrt_core::system_error& e) {
+      // Out of resources on this device, the next one may still have room
+      if (i + 1 == order.size())
+        throw;
+      shim_debug("Group failed to use device %u: %s", load.id, e.what());
+    }
+  }
+  // Not reached, the constructor rejects an empty group
+  shim_err(ENODEV, "No device in group");
+}
+
+} // namespace shim_xdna
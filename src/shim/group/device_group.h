@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef _DEVICE_GROUP_XDNA_H_
+#define _DEVICE_GROUP_XDNA_H_
+
+#include "core/common/device.h"
+#include "core/common/shim/hwctx_handle.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace shim_xdna {
+
+// Spreads hardware contexts over several NPU devices. Load is read from the
+// driver every time a context is created, so contexts of other processes are
+// taken into account. Only public device queries are used, so it lives in
+// its own library, libxrt_driver_xdna_group, which applications link to
+// instead of the shim plugin.
+class device_group
+{
+public:
+  struct device_load {
+    xrt_core::device::id_type id;
+    uint32_t total_cols;
+    uint32_t busy_cols;  // Columns used by at least one context
+    uint32_t contexts;
+    uint64_t queued;     // Commands submitted but not completed yet
+  };
+
+  explicit
+  device_group(std::vector<std::shared_ptr<xrt_core::device>> devices);
+
+  // Group of every NPU device in the system
+  static device_group
+  all();
+
+  std::vector<device_load>
+  get_load() const;
+
+  // Create the context on the device with the most free columns, then the
+  // fewest queued commands. Falls back to the next device if creation fails.
+  std::pair<std::shared_ptr<xrt_core::device>, std::unique_ptr<xrt_core::hwctx_handle>>
+  create_hw_context(const xrt::xclbin& xclbin, const xrt::hw_context::qos_type& qos,
+    xrt::hw_context::access_mode mode);
+
+private:
+  std::vector<std::shared_ptr<xrt_core::device>> m_devices;
+  // Pick and create together, so concurrent callers see each other's contexts
+  std::mutex m_lock;
+};
+
+} // namespace shim_xdna
+
+#endif
@@ -242,6 +242,7 @@ create_ctx_on_device()
   set_slotidx(arg.handle);
   set_doorbell(arg.umq_doorbell);
   set_syncobj(arg.syncobj_handle);
+  m_completed = reinterpret_cast<const uint64_t *>(arg.completed_addr);
 
   m_q->bind_hwctx(this);
 }
@@ -287,4 +288,13 @@ get_syncobj() const
   return m_syncobj;
 }
 
+bool
+hw_ctx::
+is_cmd_completed(uint64_t seq) const
+{
+  if (!m_completed)
+    return false;
+  return seq < __atomic_load_n(m_completed, __ATOMIC_ACQUIRE);
+}
+
 } // shim_xdna
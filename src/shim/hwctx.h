@@ -64,6 +64,10 @@ public:
   uint32_t
   get_syncobj() const;
 
+  // Check driver's user visible completion counter, no syscall involved
+  bool
+  is_cmd_completed(uint64_t seq) const;
+
 protected:
   uint32_t m_num_cols;
   std::unique_ptr<xrt_core::buffer_handle> m_log_bo;
@@ -101,6 +105,7 @@ private:
   uint32_t m_ops_per_cycle;
   uint32_t m_doorbell;
   uint32_t m_syncobj;
+  const uint64_t *m_completed = nullptr;
 
   void
   delete_ctx_on_device();
@@ -5,10 +5,17 @@
 #include "hwq.h"
 #include "fence.h"
 #include "shim_debug.h"
+#include "trace_ring.h"
 #include "core/common/trace.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace {
 
+// Bounds how long the reaper sleeps in the driver before rechecking for stop
+const uint32_t reaper_wait_ms = 100;
+
 uint64_t abs_now_ns()
 {
     auto now = std::chrono::high_resolution_clock::now();
@@ -23,7 +30,7 @@ get_chained_command_pkt(xrt_core::buffer_handle *boh)
   return cmdpkt->opcode == ERT_CMD_CHAIN ? cmdpkt : nullptr;
 }
 
-void
+int
 wait_cmd_syncobj(const shim_xdna::pdev& pdev, uint32_t syncobj, uint64_t seq, uint32_t timeout_ms)
 {
   int64_t timeout = std::numeric_limits<int64_t>::max();
@@ -40,10 +47,10 @@ wait_cmd_syncobj(const shim_xdna::pdev& pdev, uint32_t syncobj, uint64_t seq, ui
     .count_handles = 1,
     .flags = 0,
   };
-  pdev.ioctl(DRM_IOCTL_SYNCOBJ_TIMELINE_WAIT, &wsobj);
+  return pdev.ioctl(DRM_IOCTL_SYNCOBJ_TIMELINE_WAIT, &wsobj, { ETIME });
 }
 
-void
+int
 wait_cmd_ioctl(const shim_xdna::pdev& pdev, uint32_t ctx_id, uint64_t seq, uint32_t timeout_ms)
 {
   amdxdna_drm_wait_cmd wcmd = {
@@ -51,35 +58,30 @@ wait_cmd_ioctl(const shim_xdna::pdev& pdev, uint32_t ctx_id, uint64_t seq, uint3
     .timeout = timeout_ms,
     .seq = seq,
   };
-  pdev.ioctl(DRM_IOCTL_AMDXDNA_WAIT_CMD, &wcmd);
+  return pdev.ioctl(DRM_IOCTL_AMDXDNA_WAIT_CMD, &wcmd, { ETIME });
 }
 
 int
 wait_cmd(const shim_xdna::pdev& pdev, const shim_xdna::hw_ctx *ctx,
-  xrt_core::buffer_handle *cmd, uint32_t timeout_ms)
+  uint64_t seq, uint32_t timeout_ms)
 {
-  int ret = 1;
-  auto boh = static_cast<shim_xdna::bo*>(cmd);
-  auto id = boh->get_cmd_id();
   auto syncobj = ctx->get_syncobj();
   auto ctx_id = ctx->get_slotidx();
-  auto seq = boh->get_cmd_id();
-
-  shim_debug("Waiting for cmd (%ld)...", id);
-  
-  try {
-    if (syncobj != AMDXDNA_INVALID_FENCE_HANDLE)
-      wait_cmd_syncobj(pdev, syncobj, seq, timeout_ms);
-    else
-      wait_cmd_ioctl(pdev, ctx_id, seq, timeout_ms);
-  }
-  catch (const xrt_core::system_error& ex) {
-    if (ex.get_code() != ETIME)
-      throw;
-    else
-      ret = 0;
-  }
-  return ret;
+  int err;
+
+  shim_debug("Waiting for cmd (%ld)...", seq);
+
+  if (ctx->is_cmd_completed(seq))
+    return 1;
+
+  shim_xdna::trace::log(shim_xdna::trace::event::cmd_wait_begin, ctx_id, seq, timeout_ms);
+  // Timing out is an expected result here, don't pay for an exception
+  if (syncobj != AMDXDNA_INVALID_FENCE_HANDLE)
+    err = wait_cmd_syncobj(pdev, syncobj, seq, timeout_ms);
+  else
+    err = wait_cmd_ioctl(pdev, ctx_id, seq, timeout_ms);
+  shim_xdna::trace::log(shim_xdna::trace::event::cmd_wait_end, ctx_id, seq, err);
+  return err ? 0 : 1;
 }
 
 }
@@ -94,6 +96,12 @@ hw_q(const device& device)
 {
 }
 
+hw_q::
+~hw_q()
+{
+  stop_reaper();
+}
+
 void
 hw_q::
 bind_hwctx(const hw_ctx *ctx)
@@ -106,6 +114,8 @@ void
 hw_q::
 unbind_hwctx()
 {
+  // Callbacks still need the context to find out about completion
+  stop_reaper();
   shim_debug("Unbond HW queue from HW context %d", m_hwctx->get_slotidx());
   m_hwctx = nullptr;
 }
@@ -124,6 +134,93 @@ submit_command(xrt_core::buffer_handle *cmd)
   issue_command(cmd);
 }
 
+void
+hw_q::
+submit_command(xrt_core::buffer_handle *cmd, completion_callback cb)
+{
+  submit_command(cmd);
+
+  pending_cmd p = { cmd, static_cast<bo*>(cmd)->get_cmd_id(), std::move(cb) };
+  std::lock_guard<std::mutex> lock(m_reaper_lock);
+  // Submissions from several threads may register out of seq order
+  auto pos = std::upper_bound(m_pending.begin(), m_pending.end(), p.seq,
+    [](uint64_t seq, const pending_cmd& e) { return seq < e.seq; });
+  m_pending.insert(pos, std::move(p));
+  if (!m_reaper.joinable()) {
+    m_reaper_stop = false;
+    m_reaper = std::thread(&hw_q::reap_completions, this);
+  }
+  m_reaper_cv.notify_one();
+}
+
+void
+hw_q::
+reap_completions()
+{
+  std::unique_lock<std::mutex> lock(m_reaper_lock);
+
+  while (true) {
+    m_reaper_cv.wait(lock, [this] { return m_reaper_stop || !m_pending.empty(); });
+    // Checked between waits, so stopping takes one wait step at most
+    if (m_reaper_stop)
+      break;
+
+    // Wait on the timeline at the highest submitted point, in steps, and
+    // hand out what completed so far after each of them
+    auto last = m_pending.back().seq;
+    bool failed = false;
+    lock.unlock();
+    try {
+      wait_seq(last, reaper_wait_ms);
+    } catch (const xrt_core::system_error& e) {
+      shim_debug("Reaper failed to wait for seq %ld: %s", last, e.what());
+      failed = true;
+    }
+
+    std::vector<pending_cmd> done;
+    lock.lock();
+    // On error nothing more will complete, hand out current states
+    while (!m_pending.empty() && (failed || poll_command(m_pending.front().cmd))) {
+      done.push_back(std::move(m_pending.front()));
+      m_pending.pop_front();
+    }
+    lock.unlock();
+    run_callbacks(done);
+    lock.lock();
+  }
+
+  // Commands not done by now get their callback with the state they are in
+  std::vector<pending_cmd> left(std::make_move_iterator(m_pending.begin()),
+    std::make_move_iterator(m_pending.end()));
+  m_pending.clear();
+  lock.unlock();
+  run_callbacks(left);
+}
+
+void
+hw_q::
+run_callbacks(std::vector<pending_cmd>& cmds)
+{
+  for (auto& p : cmds) {
+    auto pkt = reinterpret_cast<ert_packet *>(p.cmd->map(xrt_core::buffer_handle::map_type::write));
+    p.cb(p.cmd, static_cast<ert_cmd_state>(pkt->state));
+  }
+}
+
+void
+hw_q::
+stop_reaper()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_reaper_lock);
+    if (!m_reaper.joinable())
+      return;
+    m_reaper_stop = true;
+  }
+  m_reaper_cv.notify_one();
+  m_reaper.join();
+}
+
 int
 hw_q::
 poll_command(xrt_core::buffer_handle *cmd) const
@@ -143,7 +240,14 @@ wait_command(xrt_core::buffer_handle *cmd, uint32_t timeout_ms) const
 {
   if (poll_command(cmd))
       return 1;
-  return wait_cmd(m_pdev, m_hwctx, cmd, timeout_ms);
+  return wait_seq(static_cast<bo*>(cmd)->get_cmd_id(), timeout_ms);
+}
+
+int
+hw_q::
+wait_seq(uint64_t seq, uint32_t timeout_ms) const
+{
+  return wait_cmd(m_pdev, m_hwctx, seq, timeout_ms);
 }
 
 void
@@ -10,16 +10,34 @@
 
 #include "core/common/shim/hwqueue_handle.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace shim_xdna {
 
 class hw_q : public xrt_core::hwqueue_handle
 {
 public:
+  // Called from the reaper thread once the command is done, with its final state
+  using completion_callback = std::function<void(xrt_core::buffer_handle *, ert_cmd_state)>;
+
   hw_q(const device& device);
 
+  ~hw_q();
+
   void
   submit_command(xrt_core::buffer_handle *) override;
 
+  // Submit without waiting for completion, cb is invoked in submission order
+  // by one reaper thread per HW context. cmd must stay alive until cb returns
+  // and cb must not destroy the HW context.
+  void
+  submit_command(xrt_core::buffer_handle *cmd, completion_callback cb);
+
   int
   poll_command(xrt_core::buffer_handle *) const override;
 
@@ -49,6 +67,15 @@ public:
   uint32_t
   get_queue_bo();
 
+  // Wait for the command with sequence number seq on this queue
+  int
+  wait_seq(uint64_t seq, uint32_t timeout_ms) const;
+
+  // Stop the reaper thread within one wait step. Callbacks of commands not
+  // done by then are run with the state the commands are in.
+  void
+  stop_reaper();
+
 protected:
   virtual void
   issue_command(xrt_core::buffer_handle *) = 0;
@@ -56,6 +83,25 @@ protected:
   const hw_ctx *m_hwctx;
   const pdev& m_pdev;
   uint32_t m_queue_boh;
+
+private:
+  struct pending_cmd {
+    xrt_core::buffer_handle *cmd;
+    uint64_t seq;
+    completion_callback cb;
+  };
+
+  void
+  reap_completions();
+
+  void
+  run_callbacks(std::vector<pending_cmd>& cmds);
+
+  std::mutex m_reaper_lock;
+  std::condition_variable m_reaper_cv;
+  std::deque<pending_cmd> m_pending;  // Sorted by seq
+  std::thread m_reaper;
+  bool m_reaper_stop = false;
 };
 
 } // shim_xdna
@@ -2,6 +2,7 @@
 // Copyright (C) 2023-2025, Advanced Micro Devices, Inc. All rights reserved.
 
 #include "bo.h"
+#include "../trace_ring.h"
 #include "core/common/config_reader.h"
 
 namespace {
@@ -60,6 +61,55 @@ sync_drm_bo(const shim_xdna::pdev& dev, uint32_t boh, xrt_core::buffer_handle::d
   dev.ioctl(DRM_IOCTL_AMDXDNA_SYNC_BO, &sbo);
 }
 
+uint32_t
+create_bo_list(const shim_xdna::pdev& dev, const std::vector<uint32_t>& handles)
+{
+  amdxdna_drm_create_bo_list cbl = {
+    .handles = reinterpret_cast<uintptr_t>(handles.data()),
+    .count = static_cast<uint32_t>(handles.size()),
+  };
+  dev.ioctl(DRM_IOCTL_AMDXDNA_CREATE_BO_LIST, &cbl);
+  return cbl.handle;
+}
+
+void
+create_drm_bos(const shim_xdna::pdev& dev, std::vector<amdxdna_drm_create_bos_entry>& entries)
+{
+  amdxdna_drm_create_bos cbos = {
+    .entries = reinterpret_cast<uintptr_t>(entries.data()),
+    .count = static_cast<uint32_t>(entries.size()),
+  };
+  dev.ioctl(DRM_IOCTL_AMDXDNA_CREATE_BOS, &cbos);
+}
+
+void
+close_drm_bo(const shim_xdna::pdev& dev, uint32_t boh)
+{
+  drm_gem_close close_bo = {boh, 0};
+  try {
+    dev.ioctl(DRM_IOCTL_GEM_CLOSE, &close_bo);
+  } catch (const xrt_core::system_error& e) {
+    shim_debug("Failed to free DRM BO: %s", e.what());
+  }
+}
+
+size_t
+page_align(size_t size)
+{
+  static const size_t page_size = getpagesize();
+
+  return (size + page_size - 1) & ~(page_size - 1);
+}
+
+void
+destroy_bo_list(const shim_xdna::pdev& dev, uint32_t hdl)
+{
+  amdxdna_drm_destroy_bo_list dbl = {
+    .handle = hdl,
+  };
+  dev.ioctl(DRM_IOCTL_AMDXDNA_DESTROY_BO_LIST, &dbl);
+}
+
 bool
 is_driver_sync()
 {
@@ -101,19 +151,86 @@ bo_kmq(const pdev& pdev, xrt_core::hwctx_handle::slot_id ctx_id, size_t size, ui
 
   alloc_bo();
   mmap_bo(align);
+  init_bo();
+}
+
+bo_kmq::
+bo_kmq(const pdev& pdev, uint64_t flags, int type, const amdxdna_drm_create_bos_entry& entry,
+  const std::shared_ptr<char>& range, size_t offset)
+  : bo(pdev, AMDXDNA_INVALID_CTX_HANDLE, entry.size, flags, type)
+{
+  alloc_bo(entry);
+  mmap_bo_at(range, offset);
+  init_bo();
+}
 
+void
+bo_kmq::
+init_bo()
+{
   // Newly allocated buffer may contain dirty pages. If used as output buffer,
   // the data in cacheline will be flushed onto memory and pollute the output
   // from device. We perform a cache flush right after the BO is allocated to
   // avoid this issue.
   if (m_type == AMDXDNA_BO_SHARE)
-    sync(direction::host2device, size, 0);
+    sync(direction::host2device, m_aligned_size, 0);
 
   attach_to_ctx();
 
   shim_debug("Allocated KMQ BO, %s", describe().c_str());
 }
 
+std::vector<std::unique_ptr<xrt_core::buffer_handle>>
+bo_kmq::
+alloc_bos(const pdev& pdev, const std::vector<size_t>& sizes, uint64_t flags, bool contiguous)
+{
+  auto type = flag_to_type(flags);
+  if (type == AMDXDNA_BO_INVALID)
+    shim_err(EINVAL, "Invalid BO flags: 0x%lx", flags);
+  if (xcl_bo_flags{flags}.use == XRT_BO_USE_DEBUG)
+    shim_err(EINVAL, "Debug BO can't be allocated in batch");
+
+  std::vector<amdxdna_drm_create_bos_entry> entries(sizes.size());
+  for (size_t i = 0; i < sizes.size(); i++) {
+    entries[i].flags = drm_bo_flags(type);
+    entries[i].size = sizes[i];
+    entries[i].type = type;
+  }
+  create_drm_bos(pdev, entries);
+
+  std::vector<std::unique_ptr<xrt_core::buffer_handle>> bos;
+  // DRM BOs before this index are owned by a bo_kmq object, including the one
+  // failed in the middle of its construction
+  size_t owned = 0;
+  try {
+    std::shared_ptr<char> range;
+    size_t range_size = 0;
+    if (contiguous) {
+      for (auto& e : entries) {
+        if (e.map_offset != AMDXDNA_INVALID_ADDR)
+          range_size += page_align(e.size);
+      }
+      if (range_size)
+        range = map_shared_range(range_size);
+    }
+
+    size_t offset = 0;
+    for (auto& e : entries) {
+      owned++;
+      bos.push_back(std::unique_ptr<bo_kmq>(new bo_kmq(pdev, flags, type, e, range, offset)));
+      if (e.map_offset != AMDXDNA_INVALID_ADDR)
+        offset += page_align(e.size);
+    }
+  } catch (...) {
+    for (auto i = owned; i < entries.size(); i++)
+      close_drm_bo(pdev, entries[i].handle);
+    throw;
+  }
+
+  shim_debug("Allocated %ld KMQ BOs in batch, contiguous %d", bos.size(), contiguous);
+  return bos;
+}
+
 bo_kmq::
 bo_kmq(const pdev& pdev, xrt_core::shared_handle::export_handle ehdl)
   : bo(pdev, ehdl)
@@ -131,6 +248,7 @@ bo_kmq::
 
   munmap_bo();
   try {
+    reset_arg_bo_list();
     detach_from_ctx();
     // If BO is in use, we should block and wait in driver
     free_bo();
@@ -143,6 +261,7 @@ void
 bo_kmq::
 sync(direction dir, size_t size, size_t offset)
 {
+  trace::log(trace::event::bo_sync, get_drm_bo_handle(), static_cast<uint64_t>(dir), offset, size);
   if (is_driver_sync()) {
     sync_drm_bo(m_pdev, get_drm_bo_handle(), dir, offset, size);
     return;
@@ -179,6 +298,7 @@ bind_at(size_t pos, const buffer_handle* bh, size_t offset, size_t size)
 
   if (!pos)
     m_args_map.clear();
+  m_args_changed = true;
 
   if (boh->get_type() != AMDXDNA_BO_CMD) {
     auto h = boh->get_drm_bo_handle();
@@ -215,4 +335,46 @@ get_arg_bo_handles(uint32_t *handles, size_t num) const
   return sz;
 }
 
+void
+bo_kmq::
+reset_arg_bo_list()
+{
+  if (m_arg_bo_list == AMDXDNA_INVALID_BO_LIST_HANDLE)
+    return;
+
+  auto hdl = m_arg_bo_list;
+  m_arg_bo_list = AMDXDNA_INVALID_BO_LIST_HANDLE;
+  destroy_bo_list(m_pdev, hdl);
+  shim_debug("Destroyed BO list %d of cmd BO %d", hdl, get_drm_bo_handle());
+}
+
+uint32_t
+bo_kmq::
+get_arg_bo_list(std::unique_lock<std::mutex>& lock)
+{
+  lock = std::unique_lock<std::mutex>(m_args_map_lock);
+
+  // Arg BOs which are bound once and submitted only once do not deserve
+  // a BO list. Create it at the second submission with the same arg BOs.
+  if (m_args_changed) {
+    m_args_changed = false;
+    reset_arg_bo_list();
+    lock.unlock();
+    return AMDXDNA_INVALID_BO_LIST_HANDLE;
+  }
+
+  if (m_arg_bo_list == AMDXDNA_INVALID_BO_LIST_HANDLE && !m_args_map.empty()) {
+    std::vector<uint32_t> hdls;
+    for (auto &m : m_args_map)
+      hdls.push_back(m.second);
+    m_arg_bo_list = create_bo_list(m_pdev, hdls);
+    shim_debug("Created BO list %d of cmd BO %d", m_arg_bo_list, get_drm_bo_handle());
+  }
+  auto hdl = m_arg_bo_list;
+  // Arg handles are read again by caller without a list, which takes the lock
+  if (hdl == AMDXDNA_INVALID_BO_LIST_HANDLE)
+    lock.unlock();
+  return hdl;
+}
+
 } // namespace shim_xdna
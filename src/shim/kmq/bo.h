@@ -30,16 +30,43 @@ public:
   // Support BO creation from internal
   bo_kmq(const pdev& pdev, size_t size, int type);
 
+  // Create BOs of given sizes in one driver call. With contiguous, mmap()'ed
+  // BOs are laid out back to back in one reserved VA range, which is only
+  // released after all of them are freed.
+  static std::vector<std::unique_ptr<xrt_core::buffer_handle>>
+  alloc_bos(const pdev& pdev, const std::vector<size_t>& sizes, uint64_t flags, bool contiguous);
+
   // Obtain array of arg BO handles, returns real number of handles
   uint32_t
   get_arg_bo_handles(uint32_t *handles, size_t num) const;
 
+  // Obtain driver BO list of arg BOs, returns AMDXDNA_INVALID_BO_LIST_HANDLE
+  // if arg BOs have changed since last submission. A valid list is returned
+  // with lock held, which keeps bind_at() from destroying the list. Hold it
+  // until the command naming the list has been submitted.
+  // The list keeps arg BOs pinned in driver even after they are freed, until
+  // arg BOs are rebound or this cmd BO is freed.
+  uint32_t
+  get_arg_bo_list(std::unique_lock<std::mutex>& lock);
+
 private:
   bo_kmq(const pdev& pdev, xrt_core::hwctx_handle::slot_id ctx_id,
     size_t size, uint64_t flags, int type);
 
+  bo_kmq(const pdev& pdev, uint64_t flags, int type, const amdxdna_drm_create_bos_entry& entry,
+    const std::shared_ptr<char>& range, size_t offset);
+
+  void
+  init_bo();
+
+  void
+  reset_arg_bo_list();
+
   // Only for AMDXDNA_BO_CMD type
   std::map<size_t, uint32_t> m_args_map;
+  // BO list created from m_args_map when it is re-submitted unchanged
+  uint32_t m_arg_bo_list = AMDXDNA_INVALID_BO_LIST_HANDLE;
+  bool m_args_changed = true;
   mutable std::mutex m_args_map_lock;
 };
 
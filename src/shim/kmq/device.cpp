@@ -5,6 +5,35 @@
 #include "device.h"
 #include "hwctx.h"
 #include "drm_local/amdxdna_accel.h"
+#include "core/common/config_reader.h"
+
+namespace {
+
+bool
+is_contiguous_bo_map()
+{
+  static int contiguous = -1;
+
+  if (contiguous == -1) {
+    bool c = xrt_core::config::detail::get_bool_value("Debug.xdna_contiguous_bo_map", false);
+    contiguous = c ? 1 : 0;
+  }
+  return contiguous == 1;
+}
+
+bool
+is_virtual_hwctx()
+{
+  static int virt = -1;
+
+  if (virt == -1) {
+    bool v = xrt_core::config::detail::get_bool_value("Debug.xdna_virtual_hwctx", false);
+    virt = v ? 1 : 0;
+  }
+  return virt == 1;
+}
+
+}
 
 namespace shim_xdna {
 
@@ -25,7 +54,18 @@ std::unique_ptr<xrt_core::hwctx_handle>
 device_kmq::
 create_hw_context(const device& dev, const xrt::xclbin& xclbin, const xrt::hw_context::qos_type& qos) const
 {
-  return std::make_unique<hw_ctx_kmq>(dev, xclbin, qos);
+  if (!is_virtual_hwctx())
+    return std::make_unique<hw_ctx_kmq>(dev, xclbin, qos);
+
+  // Contexts on the same xclbin and QoS share one firmware context
+  std::lock_guard<std::mutex> lock(m_shared_ctx_lock);
+  auto& entry = m_shared_ctx[{ xclbin.get_uuid().to_string(), qos }];
+  auto shared = entry.lock();
+  if (!shared) {
+    shared = std::make_shared<hw_ctx_kmq>(dev, xclbin, qos);
+    entry = shared;
+  }
+  return std::make_unique<hw_ctx_kmq_virt>(dev, xclbin, qos, std::move(shared));
 }
 
 std::unique_ptr<xrt_core::buffer_handle>
@@ -43,6 +83,17 @@ alloc_bo(void* userptr, xrt_core::hwctx_handle::slot_id ctx_id,
   return std::make_unique<bo_kmq>(get_pdev(), ctx_id, size, flags);
 }
 
+std::vector<std::unique_ptr<xrt_core::buffer_handle>>
+device_kmq::
+alloc_bos(const std::vector<size_t>& sizes, uint64_t flags)
+{
+  auto f = xcl_bo_flags{flags};
+  if (f.boflags == 0)
+    shim_not_supported_err("unsupported buffer type: none flag");
+
+  return bo_kmq::alloc_bos(get_pdev(), sizes, flags, is_contiguous_bo_map());
+}
+
 std::unique_ptr<xrt_core::buffer_handle>
 device_kmq::
 import_bo(xrt_core::shared_handle::export_handle ehdl) const
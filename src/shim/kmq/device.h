@@ -7,8 +7,16 @@
 #include "../device.h"
 #include "core/common/memalign.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace shim_xdna {
 
+class hw_ctx_kmq;
+
 class device_kmq : public device {
 public:
   device_kmq(const pdev& pdev, handle_type shim_handle, id_type device_id);
@@ -19,6 +27,9 @@ public:
   alloc_bo(void* userptr, xrt_core::hwctx_handle::slot_id ctx_id,
     size_t size, uint64_t flags) override;
 
+  std::vector<std::unique_ptr<xrt_core::buffer_handle>>
+  alloc_bos(const std::vector<size_t>& sizes, uint64_t flags) override;
+
 private:
   std::unique_ptr<xrt_core::hwctx_handle>
   create_hw_context(const device& dev, const xrt::xclbin& xclbin,
@@ -26,6 +37,11 @@ private:
 
   std::unique_ptr<xrt_core::buffer_handle>
   import_bo(xrt_core::shared_handle::export_handle ehdl) const override;
+
+  // HW contexts backing virtual HW contexts, by xclbin UUID and QoS
+  mutable std::mutex m_shared_ctx_lock;
+  mutable std::map<std::pair<std::string, xrt::hw_context::qos_type>,
+    std::weak_ptr<hw_ctx_kmq>> m_shared_ctx;
 };
 
 } // namespace shim_xdna
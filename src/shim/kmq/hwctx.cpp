@@ -39,10 +39,16 @@ hw_ctx_kmq(const device& device, const xrt::xclbin& xclbin, const xrt::hw_contex
   cu_conf_param->num_cus = cu_info.size();
   xcl_bo_flags f = {};
   f.flags = XRT_BO_FLAGS_CACHEABLE;
+  std::vector<size_t> pdi_sizes;
+  for (auto& ci : cu_info)
+    pdi_sizes.push_back(ci.m_pdi.size());
+  // const_cast: alloc_bos() is not const yet in device class
+  auto& dev = const_cast<device&>(get_device());
+  if (!pdi_sizes.empty())
+    m_pdi_bos = dev.alloc_bos(pdi_sizes, f.all);
   for (int i = 0; i < cu_info.size(); i++) {
     auto& ci = cu_info[i];
 
-    m_pdi_bos.push_back(alloc_bo(nullptr, ci.m_pdi.size(), f.all));
     auto& pdi_bo = m_pdi_bos[i];
     auto pdi_vaddr = reinterpret_cast<char *>(
       pdi_bo->map(xrt_core::buffer_handle::map_type::write));
@@ -86,4 +92,37 @@ alloc_bo(void* userptr, size_t size, uint64_t flags)
   return dev.alloc_bo(userptr, AMDXDNA_INVALID_CTX_HANDLE, size, flags);
 }
 
+hw_ctx_kmq_virt::
+hw_ctx_kmq_virt(const device& device, const xrt::xclbin& xclbin, const xrt::hw_context::qos_type& qos,
+  std::shared_ptr<hw_ctx_kmq> shared)
+  : hw_ctx(device, qos, std::make_unique<hw_q_kmq_virt>(device, shared.get(),
+      xrt_core::config::detail::get_uint_value("Debug.xdna_virtual_hwctx_inflight", 4)), xclbin)
+  , m_shared(std::move(shared))
+{
+  shim_debug("Created virtual KMQ HW context on (%d)", get_slotidx());
+}
+
+hw_ctx_kmq_virt::
+~hw_ctx_kmq_virt()
+{
+  // Nothing to delete on device, the shared context goes with its last user
+  shim_debug("Destroying virtual KMQ HW context on (%d)...", get_slotidx());
+  // Queue is never unbound, reap while the shared context is still around
+  static_cast<hw_q*>(get_hw_queue())->stop_reaper();
+}
+
+hw_ctx_kmq_virt::slot_id
+hw_ctx_kmq_virt::
+get_slotidx() const
+{
+  return m_shared->get_slotidx();
+}
+
+std::unique_ptr<xrt_core::buffer_handle>
+hw_ctx_kmq_virt::
+alloc_bo(void* userptr, size_t size, uint64_t flags)
+{
+  return m_shared->alloc_bo(userptr, size, flags);
+}
+
 } // shim_xdna
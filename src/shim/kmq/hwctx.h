@@ -6,6 +6,8 @@
 
 #include "../hwctx.h"
 
+#include <memory>
+
 namespace shim_xdna {
 
 class hw_ctx_kmq : public hw_ctx {
@@ -21,6 +23,26 @@ private:
   std::vector< std::unique_ptr<xrt_core::buffer_handle> > m_pdi_bos;
 };
 
+// Lightweight HW context with no firmware context of its own. Commands run
+// on a HW context shared with other virtual contexts opened on the same xclbin
+// and QoS, which stays alive as long as any of them does.
+class hw_ctx_kmq_virt : public hw_ctx {
+public:
+  hw_ctx_kmq_virt(const device& dev, const xrt::xclbin& xclbin, const qos_type& qos,
+    std::shared_ptr<hw_ctx_kmq> shared);
+
+  ~hw_ctx_kmq_virt();
+
+  slot_id
+  get_slotidx() const override;
+
+  std::unique_ptr<xrt_core::buffer_handle>
+  alloc_bo(void* userptr, size_t size, uint64_t flags) override;
+
+private:
+  std::shared_ptr<hw_ctx_kmq> m_shared;
+};
+
 } // shim_xdna
 
 #endif // _HWCTX_KMQ_H_
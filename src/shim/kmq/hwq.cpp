@@ -3,6 +3,59 @@
 
 #include "bo.h"
 #include "hwq.h"
+#include "../trace_ring.h"
+#include "core/common/config_reader.h"
+
+#include <cstring>
+
+namespace {
+
+// Assuming 1024 max args per cmd bo
+const size_t max_arg_bos = 1024;
+
+// Submit area is a header followed by one slot per submission in progress.
+// A slot holds max arg BO handles and about 340 wait points.
+const size_t submit_area_hdr_size = 64;
+const size_t submit_area_slot_size = 8 * 1024;
+const int submit_area_slots = 4;
+const size_t submit_area_size = submit_area_hdr_size + submit_area_slots * submit_area_slot_size;
+
+// Publishing a slot again when other submissions bumped the area generation
+const int max_area_retries = 3;
+
+// A virtual context at its in-flight cap waits this long at a time for its
+// oldest command, then looks again at what has completed meanwhile
+const uint32_t virt_inflight_wait_ms = 100;
+
+// Deferred waits carried by one command, more are flushed as a no-op job.
+// Well below driver's limit on syncobjs per command.
+const size_t max_inline_waits = 1024;
+
+bool
+is_inline_fences()
+{
+  static int inline_fences = -1;
+
+  if (inline_fences == -1) {
+    bool in = xrt_core::config::detail::get_bool_value("Debug.xdna_inline_fences", true);
+    inline_fences = in ? 1 : 0;
+  }
+  return inline_fences == 1;
+}
+
+bool
+is_submit_area()
+{
+  static int submit_area = -1;
+
+  if (submit_area == -1) {
+    bool sa = xrt_core::config::detail::get_bool_value("Debug.xdna_submit_area", true);
+    submit_area = sa ? 1 : 0;
+  }
+  return submit_area == 1;
+}
+
+}
 
 namespace shim_xdna {
 
@@ -22,9 +75,6 @@ void
 hw_q_kmq::
 issue_command(xrt_core::buffer_handle *cmd_bo)
 {
-  // Assuming 1024 max args per cmd bo
-  const size_t max_arg_bos = 1024;
-
   uint32_t arg_bo_hdls[max_arg_bos];
   auto boh = static_cast<bo_kmq*>(cmd_bo);
   uint32_t cmd_bo_hdl = boh->get_drm_bo_handle();
@@ -33,23 +83,344 @@ issue_command(xrt_core::buffer_handle *cmd_bo)
     .ctx = m_hwctx->get_slotidx(),
     .type = AMDXDNA_CMD_SUBMIT_EXEC_BUF,
     .cmd_handles = cmd_bo_hdl,
-    .args = reinterpret_cast<uintptr_t>(arg_bo_hdls),
     .cmd_count = 1,
-    .arg_count = static_cast<uint32_t>(boh->get_arg_bo_handles(arg_bo_hdls, max_arg_bos)),
   };
-  m_pdev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &ecmd);
+
+  std::vector<uint32_t> wait_hdls;
+  std::vector<uint64_t> wait_pts;
+  amdxdna_drm_exec_syncobjs syncobjs = {};
+  int area_slot = -1;
+  {
+    std::lock_guard<std::mutex> lock(m_wait_lock);
+    wait_hdls.swap(m_wait_hdls);
+    wait_pts.swap(m_wait_pts);
+  }
+  try {
+    if (!wait_hdls.empty())
+      fence::wait_available(m_pdev, wait_hdls, wait_pts);
+
+    // Held until the ioctl returns, a concurrent bind_at() would destroy the list
+    std::unique_lock<std::mutex> bo_list_lock;
+    auto bo_list = boh->get_arg_bo_list(bo_list_lock);
+    if (bo_list != AMDXDNA_INVALID_BO_LIST_HANDLE) {
+      ecmd.ext_flags = AMDXDNA_EXEC_FLAG_BO_LIST;
+      ecmd.args = bo_list;
+    }
+
+    auto fill_user_ptrs = [&] {
+      ecmd.ext_flags &= ~AMDXDNA_EXEC_FLAG_SUBMIT_AREA;
+      ecmd.seq = 0;
+      if (bo_list == AMDXDNA_INVALID_BO_LIST_HANDLE) {
+        ecmd.args = reinterpret_cast<uintptr_t>(arg_bo_hdls);
+        ecmd.arg_count = static_cast<uint32_t>(boh->get_arg_bo_handles(arg_bo_hdls, max_arg_bos));
+      }
+      if (!wait_hdls.empty()) {
+        syncobjs.in_handles = reinterpret_cast<uintptr_t>(wait_hdls.data());
+        syncobjs.in_points = reinterpret_cast<uintptr_t>(wait_pts.data());
+        syncobjs.in_count = static_cast<uint32_t>(wait_hdls.size());
+        ecmd.ext = reinterpret_cast<uintptr_t>(&syncobjs);
+        ecmd.ext_flags |= AMDXDNA_EXEC_FLAG_SYNCOBJS;
+      }
+    };
+
+    // The slot is only written by this submission, so no lock is needed while
+    // driver reads it. A submission publishing meanwhile fails this one with
+    // ESTALE, publish again then, or give up on the area.
+    area_slot = get_area_slot();
+    int err = ESTALE; // Until submitted through the area
+    if (area_slot >= 0 && fill_submit_area(area_slot, cmd_bo, wait_hdls, wait_pts, ecmd, syncobjs)) {
+      for (int i = 0; err == ESTALE && i < max_area_retries; i++) {
+        ecmd.seq = publish_submit_area();
+        err = m_pdev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &ecmd, { ESTALE });
+      }
+    }
+    put_area_slot(area_slot);
+    area_slot = -1;
+    if (err == ESTALE) {
+      fill_user_ptrs();
+      m_pdev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &ecmd);
+    }
+  } catch (...) {
+    put_area_slot(area_slot);
+    // Command did not make it, the next one must still wait for these
+    restore_pending_waits(wait_hdls, wait_pts);
+    throw;
+  }
 
   auto id = ecmd.seq;
   boh->set_cmd_id(id);
+  trace::log(trace::event::cmd_submit, ecmd.ctx, id, cmd_bo_hdl);
   shim_debug("Submitted command (%ld)", id);
 }
 
+int
+hw_q_kmq::
+get_area_slot()
+{
+  if (!m_area)
+    return -1;
+
+  std::lock_guard<std::mutex> lock(m_area_lock);
+  for (int i = 0; i < submit_area_slots; i++) {
+    if (!(m_area_busy & (1u << i))) {
+      m_area_busy |= 1u << i;
+      return i;
+    }
+  }
+  // All slots in use by concurrent submissions
+  return -1;
+}
+
+void
+hw_q_kmq::
+put_area_slot(int slot)
+{
+  if (slot < 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_area_lock);
+  m_area_busy &= ~(1u << slot);
+}
+
+bool
+hw_q_kmq::
+fill_submit_area(int slot, xrt_core::buffer_handle *cmd_bo, const std::vector<uint32_t>& wait_hdls,
+  const std::vector<uint64_t>& wait_pts, amdxdna_drm_exec_cmd& ecmd,
+  amdxdna_drm_exec_syncobjs& syncobjs)
+{
+  auto boh = static_cast<bo_kmq*>(cmd_bo);
+  // Arg BO handles first, then wait points and handles, all naturally aligned
+  size_t slot_off = submit_area_hdr_size + slot * submit_area_slot_size;
+  size_t arg_off = slot_off;
+  size_t pts_off = arg_off + max_arg_bos * sizeof(uint32_t);
+  size_t hdls_off = pts_off + wait_pts.size() * sizeof(uint64_t);
+
+  if (hdls_off + wait_hdls.size() * sizeof(uint32_t) > slot_off + submit_area_slot_size)
+    return false;
+
+  if (!(ecmd.ext_flags & AMDXDNA_EXEC_FLAG_BO_LIST)) {
+    auto hdls = reinterpret_cast<uint32_t *>(m_area + arg_off);
+    ecmd.args = arg_off;
+    ecmd.arg_count = static_cast<uint32_t>(boh->get_arg_bo_handles(hdls, max_arg_bos));
+  }
+  if (!wait_hdls.empty()) {
+    std::memcpy(m_area + pts_off, wait_pts.data(), wait_pts.size() * sizeof(uint64_t));
+    std::memcpy(m_area + hdls_off, wait_hdls.data(), wait_hdls.size() * sizeof(uint32_t));
+    syncobjs.in_handles = hdls_off;
+    syncobjs.in_points = pts_off;
+    syncobjs.in_count = static_cast<uint32_t>(wait_hdls.size());
+    ecmd.ext = reinterpret_cast<uintptr_t>(&syncobjs);
+    ecmd.ext_flags |= AMDXDNA_EXEC_FLAG_SYNCOBJS;
+  }
+  ecmd.ext_flags |= AMDXDNA_EXEC_FLAG_SUBMIT_AREA;
+  return true;
+}
+
+uint64_t
+hw_q_kmq::
+publish_submit_area()
+{
+  // Release: driver must see the slot content once it sees the generation
+  auto hdr = reinterpret_cast<amdxdna_submit_area_hdr *>(m_area);
+  return __atomic_add_fetch(&hdr->generation, 1, __ATOMIC_RELEASE);
+}
+
+void
+hw_q_kmq::
+init_submit_area()
+{
+  if (!is_submit_area())
+    return;
+
+  m_area = nullptr;
+  try {
+    // Allocated once, a queue bound to a new HW context registers it again
+    if (!m_area_bo) {
+      // const_cast: alloc_bo() is not const yet in device class
+      auto& dev = const_cast<device&>(m_hwctx->get_device());
+      m_area_bo = dev.alloc_bo(nullptr, AMDXDNA_INVALID_CTX_HANDLE,
+        submit_area_size, XCL_BO_FLAGS_CACHEABLE);
+    }
+    auto area = reinterpret_cast<char *>(m_area_bo->map(xrt_core::buffer_handle::map_type::write));
+
+    amdxdna_drm_config_ctx arg = {
+      .handle = m_hwctx->get_slotidx(),
+      .param_type = DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA,
+      .param_val = static_cast<bo*>(m_area_bo.get())->get_drm_bo_handle(),
+    };
+    m_pdev.ioctl(DRM_IOCTL_AMDXDNA_CONFIG_CTX, &arg);
+
+    m_area = area;
+    shim_debug("Submit area bound to HW context (%d)", m_hwctx->get_slotidx());
+  } catch (const xrt_core::system_error& e) {
+    // Older driver, arrays are copied from user pointers as before
+    m_area_bo.reset();
+    shim_debug("Submit area not used: %s", e.what());
+  }
+}
+
+void
+hw_q_kmq::
+submit_wait(const xrt_core::fence_handle* f)
+{
+  if (!is_inline_fences()) {
+    hw_q::submit_wait(f);
+    return;
+  }
+
+  auto pt = static_cast<const fence*>(f)->next_wait_point();
+  {
+    std::lock_guard<std::mutex> lock(m_wait_lock);
+    m_wait_hdls.push_back(pt.first);
+    m_wait_pts.push_back(pt.second);
+    if (m_wait_hdls.size() < max_inline_waits)
+      return;
+  }
+  // Too many for one command, depend on them through a no-op job now
+  flush_pending_waits();
+}
+
+void
+hw_q_kmq::
+submit_wait(const std::vector<xrt_core::fence_handle*>& fences)
+{
+  if (!is_inline_fences() || fences.size() > max_inline_waits) {
+    hw_q::submit_wait(fences);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_wait_lock);
+    fence::next_wait_points(fences, m_wait_hdls, m_wait_pts);
+    if (m_wait_hdls.size() < max_inline_waits)
+      return;
+  }
+  flush_pending_waits();
+}
+
+void
+hw_q_kmq::
+submit_signal(const xrt_core::fence_handle* f)
+{
+  // A signal must not overtake waits submitted before it
+  flush_pending_waits();
+  hw_q::submit_signal(f);
+}
+
+void
+hw_q_kmq::
+flush_pending_waits()
+{
+  std::vector<uint32_t> wait_hdls;
+  std::vector<uint64_t> wait_pts;
+
+  {
+    std::lock_guard<std::mutex> lock(m_wait_lock);
+    wait_hdls.swap(m_wait_hdls);
+    wait_pts.swap(m_wait_pts);
+  }
+  if (wait_hdls.empty())
+    return;
+
+  try {
+    fence::submit_wait(m_pdev, m_hwctx, wait_hdls, wait_pts);
+  } catch (...) {
+    restore_pending_waits(wait_hdls, wait_pts);
+    throw;
+  }
+}
+
+void
+hw_q_kmq::
+restore_pending_waits(std::vector<uint32_t>& wait_hdls, std::vector<uint64_t>& wait_pts)
+{
+  std::lock_guard<std::mutex> lock(m_wait_lock);
+
+  // Keep order, waits added meanwhile go after the restored ones
+  wait_hdls.insert(wait_hdls.end(), m_wait_hdls.begin(), m_wait_hdls.end());
+  wait_pts.insert(wait_pts.end(), m_wait_pts.begin(), m_wait_pts.end());
+  m_wait_hdls.swap(wait_hdls);
+  m_wait_pts.swap(wait_pts);
+}
+
 void
 hw_q_kmq::
 bind_hwctx(const hw_ctx *ctx)
 {
   // link hwctx by parent class
   hw_q::bind_hwctx(ctx);
+  init_submit_area();
+}
+
+hw_q_kmq_virt::
+hw_q_kmq_virt(const device& device, hw_ctx *shared_ctx, size_t max_inflight)
+  : hw_q(device)
+  , m_shared_q(static_cast<hw_q*>(shared_ctx->get_hw_queue()))
+  , m_max_inflight(max_inflight ? max_inflight : 1)
+{
+  // Waits and polls go straight to the shared HW context
+  hw_q::bind_hwctx(shared_ctx);
+  shim_debug("Created virtual KMQ HW queue");
+}
+
+hw_q_kmq_virt::
+~hw_q_kmq_virt()
+{
+  shim_debug("Destroying virtual KMQ HW queue, %ld cmds submitted", m_submitted);
+}
+
+void
+hw_q_kmq_virt::
+retire_completed()
+{
+  while (!m_inflight.empty() && m_hwctx->is_cmd_completed(m_inflight.front()))
+    m_inflight.pop_front();
+}
+
+void
+hw_q_kmq_virt::
+issue_command(xrt_core::buffer_handle *cmd_bo)
+{
+  std::unique_lock<std::mutex> lock(m_lock);
+
+  retire_completed();
+  while (m_inflight.size() >= m_max_inflight) {
+    // Only wait for our own commands, other virtual contexts keep going.
+    // Not under the lock, other threads of this context may retire it too.
+    auto seq = m_inflight.front();
+    lock.unlock();
+    auto done = m_shared_q->wait_seq(seq, virt_inflight_wait_ms) > 0;
+    lock.lock();
+    if (done && !m_inflight.empty() && m_inflight.front() == seq)
+      m_inflight.pop_front();
+    retire_completed();
+  }
+
+  // Held across submission, so m_inflight stays in submission order
+  m_shared_q->submit_command(cmd_bo);
+  m_inflight.push_back(static_cast<bo*>(cmd_bo)->get_cmd_id());
+  m_submitted++;
+}
+
+void
+hw_q_kmq_virt::
+submit_wait(const xrt_core::fence_handle* f)
+{
+  m_shared_q->submit_wait(f);
+}
+
+void
+hw_q_kmq_virt::
+submit_wait(const std::vector<xrt_core::fence_handle*>& fences)
+{
+  m_shared_q->submit_wait(fences);
+}
+
+void
+hw_q_kmq_virt::
+submit_signal(const xrt_core::fence_handle* f)
+{
+  m_shared_q->submit_signal(f);
 }
 
 } // shim_xdna
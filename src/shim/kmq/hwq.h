@@ -6,6 +6,11 @@
 
 #include "../hwq.h"
 
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace shim_xdna {
 
 class hw_q_kmq : public hw_q
@@ -20,6 +25,95 @@ public:
 
   void
   issue_command(xrt_core::buffer_handle *) override;
+
+  // Waits are carried by the next command instead of a dependency job
+  void
+  submit_wait(const xrt_core::fence_handle*) override;
+
+  void
+  submit_wait(const std::vector<xrt_core::fence_handle*>&) override;
+
+  void
+  submit_signal(const xrt_core::fence_handle*) override;
+
+private:
+  void
+  flush_pending_waits();
+
+  // Put back waits taken for a submission which failed
+  void
+  restore_pending_waits(std::vector<uint32_t>& wait_hdls, std::vector<uint64_t>& wait_pts);
+
+  void
+  init_submit_area();
+
+  // Returns a free slot of the submit area, -1 if there is none
+  int
+  get_area_slot();
+
+  void
+  put_area_slot(int slot);
+
+  bool
+  fill_submit_area(int slot, xrt_core::buffer_handle *cmd_bo, const std::vector<uint32_t>& wait_hdls,
+    const std::vector<uint64_t>& wait_pts, amdxdna_drm_exec_cmd& ecmd,
+    amdxdna_drm_exec_syncobjs& syncobjs);
+
+  // Returns the new area generation to pass with the submission
+  uint64_t
+  publish_submit_area();
+
+  std::mutex m_wait_lock;
+  std::vector<uint32_t> m_wait_hdls;
+  std::vector<uint64_t> m_wait_pts;
+
+  // Argument and wait arrays are passed to driver in place through this BO
+  std::unique_ptr<xrt_core::buffer_handle> m_area_bo;
+  char *m_area = nullptr;
+  // Slots of the area in use by submissions
+  std::mutex m_area_lock;
+  uint32_t m_area_busy = 0;
+};
+
+// Queue of a virtual HW context. Commands are forwarded, in submission order,
+// to the queue of the HW context shared by all virtual contexts opened on the
+// same xclbin and QoS. Each virtual context may only have a limited number of
+// commands in flight, so one busy tenant can not fill up the shared queue.
+class hw_q_kmq_virt : public hw_q
+{
+public:
+  hw_q_kmq_virt(const device& device, hw_ctx *shared_ctx, size_t max_inflight);
+
+  ~hw_q_kmq_virt();
+
+  // Always bound to the shared HW context
+  void
+  bind_hwctx(const hw_ctx *ctx) override
+  {}
+
+  void
+  issue_command(xrt_core::buffer_handle *) override;
+
+  void
+  submit_wait(const xrt_core::fence_handle*) override;
+
+  void
+  submit_wait(const std::vector<xrt_core::fence_handle*>&) override;
+
+  void
+  submit_signal(const xrt_core::fence_handle*) override;
+
+private:
+  void
+  retire_completed();
+
+  hw_q *m_shared_q;
+  const size_t m_max_inflight;
+
+  // Sequence numbers of this virtual context's commands not known to be done
+  std::mutex m_lock;
+  std::deque<uint64_t> m_inflight;
+  uint64_t m_submitted = 0;
 };
 
 } // shim_xdna
@@ -8,6 +8,8 @@
 #include "drm_local/amdxdna_accel.h"
 #include "core/common/trace.h"
 
+#include <algorithm>
+
 namespace {
 
   std::string
@@ -34,6 +36,14 @@ namespace {
       return "DRM_IOCTL_AMDXDNA_GET_INFO";
     case DRM_IOCTL_AMDXDNA_SET_STATE:
       return "DRM_IOCTL_AMDXDNA_SET_STATE";
+    case DRM_IOCTL_AMDXDNA_CREATE_BO_LIST:
+      return "DRM_IOCTL_AMDXDNA_CREATE_BO_LIST";
+    case DRM_IOCTL_AMDXDNA_DESTROY_BO_LIST:
+      return "DRM_IOCTL_AMDXDNA_DESTROY_BO_LIST";
+    case DRM_IOCTL_AMDXDNA_SYNC_BOS:
+      return "DRM_IOCTL_AMDXDNA_SYNC_BOS";
+    case DRM_IOCTL_AMDXDNA_CREATE_BOS:
+      return "DRM_IOCTL_AMDXDNA_CREATE_BOS";
     case DRM_IOCTL_GEM_CLOSE:
       return "DRM_IOCTL_GEM_CLOSE";
     case DRM_IOCTL_PRIME_HANDLE_TO_FD:
@@ -135,6 +145,20 @@ ioctl(unsigned long cmd, void* arg) const
     shim_err(errno, "%s IOCTL failed", ioctl_cmd2name(cmd).c_str());
 }
 
+int
+pdev::
+ioctl(unsigned long cmd, void* arg, std::initializer_list<int> expected) const
+{
+  XRT_TRACE_POINT_SCOPE2(ioctl, cmd, arg);
+  if (xrt_core::pci::dev::ioctl(m_dev_fd, cmd, arg) != -1)
+    return 0;
+
+  int err = errno;
+  if (std::find(expected.begin(), expected.end(), err) == expected.end())
+    shim_err(err, "%s IOCTL failed", ioctl_cmd2name(cmd).c_str());
+  return err;
+}
+
 void*
 pdev::
 mmap(void *addr, size_t len, int prot, int flags, off_t offset) const
@@ -9,6 +9,8 @@
 #include "core/pcie/linux/device_linux.h"
 #include "core/pcie/linux/pcidev.h"
 
+#include <initializer_list>
+
 namespace shim_xdna {
 
 class pdev : public xrt_core::pci::dev
@@ -28,6 +30,12 @@ public:
   void
   ioctl(unsigned long cmd, void* arg) const;
 
+  // Same as ioctl(), but an errno listed in 'expected' is returned instead of
+  // thrown. Returns 0 on success. Used where failure is a normal outcome, e.g.
+  // ETIME from a wait with timeout.
+  int
+  ioctl(unsigned long cmd, void* arg, std::initializer_list<int> expected) const;
+
   void*
   mmap(void *addr, size_t len, int prot, int flags, off_t offset) const;
 
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+#include "trace_ring.h"
+#include "core/common/config_reader.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+// Events kept per thread, older ones are overwritten
+const size_t ring_entries = 4096;
+
+// On-disk layout, keep in sync with tools/xdna_trace_dump
+struct file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t pid;
+  uint64_t ticks_per_sec;
+  uint64_t nrecords;
+};
+
+struct entry {
+  uint64_t ts;
+  uint32_t tid;
+  uint16_t id;
+  uint16_t pad;
+  uint64_t args[4];
+};
+
+struct ring {
+  std::atomic<uint64_t> head{0};
+  std::array<entry, ring_entries> entries;
+};
+
+struct registry {
+  std::mutex lock;
+  std::vector<std::unique_ptr<ring>> rings;
+  // Rings of exited threads, handed to new threads
+  std::vector<ring*> free_rings;
+  std::string dir;
+  uint64_t ticks0;
+  uint64_t ns0;
+};
+
+// Never destroyed, threads may still record while static objects go away
+registry&
+get_registry()
+{
+  static auto reg = new registry;
+  return *reg;
+}
+
+uint64_t
+steady_ns()
+{
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+uint64_t
+now_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return steady_ns();
+#endif
+}
+
+struct ring_holder {
+  ring* r = nullptr;
+  uint32_t tid = 0;
+
+  ~ring_holder()
+  {
+    if (!r)
+      return;
+    auto& reg = get_registry();
+    std::lock_guard<std::mutex> lock(reg.lock);
+    reg.free_rings.push_back(r);
+  }
+};
+
+thread_local ring_holder t_ring;
+
+ring*
+acquire_ring()
+{
+  auto& reg = get_registry();
+  std::lock_guard<std::mutex> lock(reg.lock);
+
+  // Entries carry the tid, so a reused ring still decodes correctly
+  if (!reg.free_rings.empty()) {
+    t_ring.r = reg.free_rings.back();
+    reg.free_rings.pop_back();
+  } else {
+    reg.rings.push_back(std::make_unique<ring>());
+    t_ring.r = reg.rings.back().get();
+  }
+  t_ring.tid = static_cast<uint32_t>(syscall(SYS_gettid));
+  return t_ring.r;
+}
+
+void
+dump()
+{
+  auto& reg = get_registry();
+  std::lock_guard<std::mutex> lock(reg.lock);
+
+  uint64_t ticks = now_ticks() - reg.ticks0;
+  uint64_t ns = steady_ns() - reg.ns0;
+  file_header hdr = {
+    .magic = { 'X', 'D', 'N', 'A', 'T', 'R', 'C', '1' },
+    .version = 1,
+    .pid = static_cast<uint32_t>(getpid()),
+    .ticks_per_sec = ns ? static_cast<uint64_t>(static_cast<double>(ticks) * 1e9 / ns) : 0,
+    .nrecords = 0,
+  };
+  // Threads still running at exit keep recording, header and written
+  // entries must agree on one head per ring
+  std::vector<uint64_t> heads;
+  for (auto& r : reg.rings) {
+    heads.push_back(r->head.load(std::memory_order_acquire));
+    hdr.nrecords += std::min<uint64_t>(heads.back(), ring_entries);
+  }
+
+  auto path = reg.dir + "/xdna_trace." + std::to_string(hdr.pid) + ".bin";
+  auto fp = std::fopen(path.c_str(), "wb");
+  if (!fp) {
+    std::fprintf(stderr, "XDNA trace: failed to open %s\n", path.c_str());
+    return;
+  }
+
+  std::fwrite(&hdr, sizeof(hdr), 1, fp);
+  for (size_t k = 0; k < reg.rings.size(); k++) {
+    auto& r = reg.rings[k];
+    // Threads still running at exit may overwrite the oldest entries meanwhile
+    uint64_t head = heads[k];
+    uint64_t n = std::min<uint64_t>(head, ring_entries);
+    for (uint64_t i = head - n; i < head; i++)
+      std::fwrite(&r->entries[i % ring_entries], sizeof(entry), 1, fp);
+  }
+  std::fclose(fp);
+  std::fprintf(stderr, "XDNA trace: %lu events written to %s\n", hdr.nrecords, path.c_str());
+}
+
+} // namespace
+
+namespace shim_xdna::trace {
+
+bool
+init()
+{
+  std::string dir;
+
+  if (auto env = std::getenv("XDNA_SHIM_TRACE"))
+    dir = env;
+  else if (xrt_core::config::detail::get_bool_value("Debug.xdna_trace_ring", false))
+    dir = xrt_core::config::detail::get_string_value("Debug.xdna_trace_dir", "/tmp");
+  if (dir.empty())
+    return false;
+
+  auto& reg = get_registry();
+  reg.dir = dir;
+  reg.ticks0 = now_ticks();
+  reg.ns0 = steady_ns();
+  std::atexit(dump);
+  return true;
+}
+
+void
+record(event id, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3)
+{
+  auto r = t_ring.r ? t_ring.r : acquire_ring();
+  // Single writer per ring, the dump only needs to see a consistent head
+  auto head = r->head.load(std::memory_order_relaxed);
+  auto& e = r->entries[head % ring_entries];
+
+  e.ts = now_ticks();
+  e.tid = t_ring.tid;
+  e.id = static_cast<uint16_t>(id);
+  e.pad = 0;
+  e.args[0] = a0;
+  e.args[1] = a1;
+  e.args[2] = a2;
+  e.args[3] = a3;
+  r->head.store(head + 1, std::memory_order_release);
+}
+
+} // namespace shim_xdna::trace
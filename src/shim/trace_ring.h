@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef TRACE_RING_XDNA_H
+#define TRACE_RING_XDNA_H
+
+#include <cstdint>
+
+// Per-thread binary event trace, enabled at runtime with
+//   XDNA_SHIM_TRACE=<output dir>
+// or with xrt.ini
+//   [Debug]
+//   xdna_trace_ring=true
+//   xdna_trace_dir=<output dir, default /tmp>
+// Each thread records into its own ring, nothing is formatted at record time.
+// Rings are written to <dir>/xdna_trace.<pid>.bin at process exit and can be
+// decoded with tools/xdna_trace_dump.
+
+namespace shim_xdna::trace {
+
+// Keep in sync with tools/xdna_trace_dump
+enum class event : uint16_t {
+  cmd_submit = 1,  // ctx, seq, cmd bo handle
+  cmd_wait_begin,  // ctx, seq, timeout ms
+  cmd_wait_end,    // ctx, seq, errno (0 means completed)
+  bo_alloc,        // bo handle, type, size
+  bo_free,         // bo handle
+  bo_sync,         // bo handle, direction, offset, size
+};
+
+bool
+init();
+
+void
+record(event id, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3);
+
+inline bool
+enabled()
+{
+  static const bool on = init();
+  return on;
+}
+
+inline void
+log(event id, uint64_t a0 = 0, uint64_t a1 = 0, uint64_t a2 = 0, uint64_t a3 = 0)
+{
+  if (enabled())
+    record(id, a0, a1, a2, a3);
+}
+
+} // namespace shim_xdna::trace
+
+#endif
@@ -43,8 +43,6 @@ int
 wait_slot(const shim_xdna::pdev& pdev, const shim_xdna::hw_ctx *ctx,
   uint64_t cmd_id, uint32_t timeout_ms)
 {
-  int ret = 1;
-
   shim_debug("waiting for cmd_id (%ld)...", cmd_id);
 
   amdxdna_drm_wait_cmd wcmd = {
@@ -53,16 +51,7 @@ wait_slot(const shim_xdna::pdev& pdev, const shim_xdna::hw_ctx *ctx,
     .seq = cmd_id,
   };
 
-  try {
-    pdev.ioctl(DRM_IOCTL_AMDXDNA_WAIT_CMD, &wcmd);
-  }
-  catch (const xrt_core::system_error& ex) {
-    if (ex.get_code() != ETIME)
-      throw;
-    else
-      ret = 0;
-  }
-  return ret;
+  return pdev.ioctl(DRM_IOCTL_AMDXDNA_WAIT_CMD, &wcmd, { ETIME }) ? 0 : 1;
 }
 
 }
@@ -8,8 +8,10 @@
 #include "dev_info.h"
 #include "exec_buf.h"
 #include "io_config.h"
+#include "speed.h"
 
 #include "core/common/system.h"
+#include "core/common/config_reader.h"
 #include "core/common/shim/fence_handle.h"
 #include <algorithm>
 
@@ -164,3 +166,84 @@ TEST_cmd_fence_device(device::id_type id, std::shared_ptr<device> sdev, arg_type
   test_2proc_cmd_fence_device t2p(id);
   t2p.run_test();
 }
+
+void
+TEST_cmd_fence_pipeline_latency(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  unsigned int total = static_cast<unsigned int>(arg[0]);
+
+  // Producer context signals a fence which consumer context depends on
+  hw_ctx pctx{dev};
+  hw_ctx cctx{dev};
+  auto pq = pctx.get()->get_hw_queue();
+  auto cq = cctx.get()->get_hw_queue();
+
+  io_test_bo_set pboset{dev};
+  io_test_bo_set cboset{dev};
+  init_noop_cmd(pboset, pctx.get(), dev);
+  init_noop_cmd(cboset, cctx.get(), dev);
+  auto pcbo = pboset.get_bos()[IO_TEST_BO_CMD].tbo;
+  auto ccbo = cboset.get_bos()[IO_TEST_BO_CMD].tbo;
+  auto ppkt = reinterpret_cast<ert_start_kernel_cmd *>(pcbo->map());
+  auto cpkt = reinterpret_cast<ert_start_kernel_cmd *>(ccbo->map());
+
+  auto sfence = dev->create_fence(fence_handle::access_mode::process);
+  auto wfence = sfence->clone();
+
+  auto start = clk::now();
+  for (unsigned int i = 0; i < total; i++) {
+    pq->submit_command(pcbo->get());
+    pq->submit_signal(sfence.get());
+    cq->submit_wait(wfence.get());
+    cq->submit_command(ccbo->get());
+    cq->wait_command(ccbo->get(), 0);
+    check_and_reset_cmd(ppkt);
+    check_and_reset_cmd(cpkt);
+  }
+  auto end = clk::now();
+
+  bool inline_fences = xrt_core::config::detail::get_bool_value("Debug.xdna_inline_fences", true);
+  auto duration_us = std::chrono::duration_cast<us_t>(end - start).count();
+  std::cout << total << " producer/consumer iterations finished in " << duration_us << " us, "
+            << "dependency by " << (inline_fences ? "in-fence" : "no-op job") << ", "
+            << "Average latency " << static_cast<double>(duration_us) / total << " us" << std::endl;
+}
+
+void
+TEST_cmd_wait_timeout_loop(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  unsigned int total = static_cast<unsigned int>(arg[0]);
+  const uint32_t timeout_ms = 1;
+
+  hw_ctx hwctx{dev};
+  auto hwq = hwctx.get()->get_hw_queue();
+  io_test_bo_set boset{dev};
+  init_noop_cmd(boset, hwctx.get(), dev);
+  auto cbo = boset.get_bos()[IO_TEST_BO_CMD].tbo;
+  auto cpkt = reinterpret_cast<ert_start_kernel_cmd *>(cbo->map());
+
+  // Hold the command behind an unsignaled fence so that every wait times out
+  auto sfence = dev->create_fence(fence_handle::access_mode::process);
+  auto wfence = sfence->clone();
+  hwq->submit_wait(wfence.get());
+  hwq->submit_command(cbo->get());
+
+  auto start = clk::now();
+  for (unsigned int i = 0; i < total; i++) {
+    if (hwq->wait_command(cbo->get(), timeout_ms))
+      throw std::runtime_error("Command completed before its fence was signaled");
+  }
+  auto end = clk::now();
+
+  sfence->signal();
+  hwq->wait_command(cbo->get(), 0);
+  check_and_reset_cmd(cpkt);
+
+  auto duration_us = std::chrono::duration_cast<us_t>(end - start).count();
+  auto per_wait_us = static_cast<double>(duration_us) / total;
+  std::cout << total << " timed out waits finished in " << duration_us << " us, "
+            << "Average " << per_wait_us << " us per " << timeout_ms << " ms wait, "
+            << "overhead " << per_wait_us - timeout_ms * 1000.0 << " us" << std::endl;
+}
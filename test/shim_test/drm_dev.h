@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef _SHIMTEST_DRM_DEV_H_
+#define _SHIMTEST_DRM_DEV_H_
+
+#include "core/common/device.h"
+#include "core/common/query_requests.h"
+#include "drm_local/amdxdna_accel.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// Opens the accel node of a device directly, to test driver interfaces which
+// are not reachable through the shim. This is a DRM client of its own, BO and
+// syncobj handles are not shared with the XRT device.
+class drm_dev {
+public:
+  drm_dev(xrt_core::device* dev)
+  {
+    auto bdf = xrt_core::device_query<xrt_core::query::pcie_bdf>(dev);
+    char name[32];
+    snprintf(name, sizeof(name), "%04x:%02x:%02x.%x",
+      std::get<0>(bdf), std::get<1>(bdf), std::get<2>(bdf), std::get<3>(bdf));
+
+    auto accel = std::filesystem::path("/sys/bus/pci/devices") / name / "accel";
+    for (const auto& e : std::filesystem::directory_iterator(accel)) {
+      auto node = "/dev/accel/" + e.path().filename().string();
+      m_fd = open(node.c_str(), O_RDWR);
+      if (m_fd < 0)
+        throw std::runtime_error("Failed to open " + node);
+      return;
+    }
+    throw std::runtime_error(std::string("No accel node for ") + name);
+  }
+
+  ~drm_dev()
+  {
+    close(m_fd);
+  }
+
+  // Returns errno, 0 on success
+  int
+  ioctl(unsigned long cmd, void* arg) const
+  {
+    return ::ioctl(m_fd, cmd, arg) ? errno : 0;
+  }
+
+  void
+  ioctl_chk(unsigned long cmd, void* arg, const char *what) const
+  {
+    auto err = ioctl(cmd, arg);
+    if (err)
+      throw std::runtime_error(std::string(what) + " failed, errno " + std::to_string(err));
+  }
+
+  uint32_t
+  create_bo(uint32_t type, size_t size) const
+  {
+    amdxdna_drm_create_bo cbo = {};
+    cbo.size = size;
+    cbo.type = type;
+    ioctl_chk(DRM_IOCTL_AMDXDNA_CREATE_BO, &cbo, "CREATE_BO");
+    return cbo.handle;
+  }
+
+  void
+  close_bo(uint32_t hdl) const
+  {
+    drm_gem_close arg = {};
+    arg.handle = hdl;
+    ioctl(DRM_IOCTL_GEM_CLOSE, &arg);
+  }
+
+  amdxdna_drm_get_bo_info
+  get_bo_info(uint32_t hdl) const
+  {
+    amdxdna_drm_get_bo_info info = {};
+    info.handle = hdl;
+    ioctl_chk(DRM_IOCTL_AMDXDNA_GET_BO_INFO, &info, "GET_BO_INFO");
+    return info;
+  }
+
+  // Returns MAP_FAILED with errno set on failure
+  void *
+  map(size_t size, int prot, uint64_t offset) const
+  {
+    return ::mmap(nullptr, size, prot, MAP_SHARED, m_fd, offset);
+  }
+
+  // Maps a BO at an address aligned to align, unmap it with munmap(ret, size)
+  void *
+  map_bo(uint32_t hdl, size_t size, size_t align) const
+  {
+    auto offset = get_bo_info(hdl).map_offset;
+    auto range = ::mmap(nullptr, size + align, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (range == MAP_FAILED)
+      throw std::runtime_error("Failed to reserve VA range, errno " + std::to_string(errno));
+
+    // Keep only the aligned part of the reserved range
+    auto start = reinterpret_cast<uintptr_t>(range);
+    auto aligned = (start + align - 1) & ~(align - 1);
+    if (aligned > start)
+      ::munmap(range, aligned - start);
+    if (start + align > aligned)
+      ::munmap(reinterpret_cast<void *>(aligned + size), start + align - aligned);
+
+    auto p = ::mmap(reinterpret_cast<void *>(aligned), size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_FIXED, m_fd, offset);
+    if (p == MAP_FAILED) {
+      ::munmap(reinterpret_cast<void *>(aligned), size);
+      throw std::runtime_error("Failed to map BO " + std::to_string(hdl) + ", errno " + std::to_string(errno));
+    }
+    return p;
+  }
+
+  // Context without UMQ and log buffer, returns what driver filled in
+  amdxdna_drm_create_ctx
+  create_ctx(uint32_t num_tiles) const
+  {
+    amdxdna_qos_info qos = {};
+    amdxdna_drm_create_ctx arg = {};
+    arg.qos_p = reinterpret_cast<uintptr_t>(&qos);
+    arg.umq_bo = AMDXDNA_INVALID_BO_HANDLE;
+    arg.log_buf_bo = AMDXDNA_INVALID_BO_HANDLE;
+    arg.max_opc = 2048;
+    arg.num_tiles = num_tiles;
+    ioctl_chk(DRM_IOCTL_AMDXDNA_CREATE_CTX, &arg, "CREATE_CTX");
+    arg.qos_p = 0;
+    return arg;
+  }
+
+  void
+  destroy_ctx(uint32_t hdl) const
+  {
+    amdxdna_drm_destroy_ctx arg = {};
+    arg.handle = hdl;
+    ioctl(DRM_IOCTL_AMDXDNA_DESTROY_CTX, &arg);
+  }
+
+  uint32_t
+  create_syncobj() const
+  {
+    drm_syncobj_create arg = {};
+    ioctl_chk(DRM_IOCTL_SYNCOBJ_CREATE, &arg, "SYNCOBJ_CREATE");
+    return arg.handle;
+  }
+
+  void
+  destroy_syncobj(uint32_t hdl) const
+  {
+    drm_syncobj_destroy arg = {};
+    arg.handle = hdl;
+    ioctl(DRM_IOCTL_SYNCOBJ_DESTROY, &arg);
+  }
+
+  void
+  signal_syncobj(uint32_t hdl, uint64_t point) const
+  {
+    drm_syncobj_timeline_array arg = {};
+    arg.handles = reinterpret_cast<uintptr_t>(&hdl);
+    arg.points = reinterpret_cast<uintptr_t>(&point);
+    arg.count_handles = 1;
+    ioctl_chk(DRM_IOCTL_SYNCOBJ_TIMELINE_SIGNAL, &arg, "SYNCOBJ_TIMELINE_SIGNAL");
+  }
+
+  // Returns errno of a timeline wait with relative timeout,
+  // ETIME if not signaled in time, EINVAL if there is no fence at all
+  int
+  wait_syncobj(uint32_t hdl, uint64_t point, int64_t timeout_ms) const
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t abs_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec + timeout_ms * 1000000LL;
+
+    drm_syncobj_timeline_wait arg = {};
+    arg.handles = reinterpret_cast<uintptr_t>(&hdl);
+    arg.points = reinterpret_cast<uintptr_t>(&point);
+    arg.timeout_nsec = abs_ns;
+    arg.count_handles = 1;
+    return ioctl(DRM_IOCTL_SYNCOBJ_TIMELINE_WAIT, &arg);
+  }
+
+  // Returns errno, size is updated to what driver returned
+  int
+  get_info(uint32_t param, void* buf, uint32_t& size) const
+  {
+    amdxdna_drm_get_info arg = {};
+    arg.param = param;
+    arg.buffer_size = size;
+    arg.buffer = reinterpret_cast<uintptr_t>(buf);
+    auto err = ioctl(DRM_IOCTL_AMDXDNA_GET_INFO, &arg);
+    size = arg.buffer_size;
+    return err;
+  }
+
+  // Contexts of all processes using the device
+  std::vector<amdxdna_drm_query_ctx>
+  get_hw_contexts() const
+  {
+    std::vector<amdxdna_drm_query_ctx> ctxs(64);
+    auto size = static_cast<uint32_t>(ctxs.size() * sizeof(ctxs[0]));
+    auto err = get_info(DRM_AMDXDNA_QUERY_HW_CONTEXTS, ctxs.data(), size);
+    if (err == EINVAL && size > ctxs.size() * sizeof(ctxs[0])) {
+      // More contexts than expected, size tells how many
+      ctxs.resize(size / sizeof(ctxs[0]));
+      err = get_info(DRM_AMDXDNA_QUERY_HW_CONTEXTS, ctxs.data(), size);
+    }
+    if (err)
+      throw std::runtime_error("Query HW contexts failed, errno " + std::to_string(err));
+    ctxs.resize(size / sizeof(ctxs[0]));
+    return ctxs;
+  }
+
+  // Returns errno, most states need root
+  int
+  set_state(uint32_t param, void* buf, uint32_t size) const
+  {
+    amdxdna_drm_set_state arg = {};
+    arg.param = param;
+    arg.buffer_size = size;
+    arg.buffer = reinterpret_cast<uintptr_t>(buf);
+    return ioctl(DRM_IOCTL_AMDXDNA_SET_STATE, &arg);
+  }
+
+private:
+  int m_fd = -1;
+};
+
+#endif // _SHIMTEST_DRM_DEV_H_
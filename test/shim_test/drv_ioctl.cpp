@@ -0,0 +1,570 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+// Tests of driver interfaces which the shim does not use (yet)
+
+#include "drm_dev.h"
+#include "io_param.h"
+#include "speed.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace xrt_core;
+using arg_type = const std::vector<uint64_t>;
+
+int
+set_client_budget(const drm_dev& ddev, uint32_t pct)
+{
+  amdxdna_drm_set_client_budget budget = {};
+  budget.pid = getpid();
+  budget.budget_pct = pct;
+  return ddev.set_state(DRM_AMDXDNA_SET_CLIENT_BUDGET, &budget, sizeof(budget));
+}
+
+// Usage of all clients opened by this process
+std::vector<amdxdna_drm_query_client_usage>
+get_client_usage(const drm_dev& ddev)
+{
+  std::vector<amdxdna_drm_query_client_usage> usage(64);
+  auto size = static_cast<uint32_t>(usage.size() * sizeof(usage[0]));
+  auto err = ddev.get_info(DRM_AMDXDNA_QUERY_CLIENT_USAGE, usage.data(), size);
+  if (err)
+    throw std::runtime_error("Query client usage failed, errno " + std::to_string(err));
+  usage.resize(size / sizeof(usage[0]));
+
+  auto mine = std::remove_if(usage.begin(), usage.end(),
+    [](const auto& u) { return u.pid != getpid(); });
+  usage.erase(mine, usage.end());
+  return usage;
+}
+
+void
+expect_errno(int err, int expected, const std::string& what)
+{
+  if (err != expected) {
+    throw std::runtime_error(what + ": errno " + std::to_string(err) +
+      ", expecting " + std::to_string(expected));
+  }
+}
+
+int
+sync_bos(const drm_dev& ddev, std::vector<amdxdna_drm_sync_bo>& entries,
+  uint32_t syncobj, uint64_t point)
+{
+  amdxdna_drm_sync_bos arg = {};
+  arg.entries = reinterpret_cast<uintptr_t>(entries.data());
+  arg.count = static_cast<uint32_t>(entries.size());
+  if (syncobj) {
+    arg.flags = AMDXDNA_SYNC_BOS_FLAG_ASYNC;
+    arg.syncobj = syncobj;
+    arg.point = point;
+  }
+  return ddev.ioctl(DRM_IOCTL_AMDXDNA_SYNC_BOS, &arg);
+}
+
+// Device heap of a drm_dev client, device BOs and contexts need it
+class dev_heap {
+public:
+  dev_heap(const drm_dev& ddev) : m_ddev(ddev)
+  {
+    m_hdl = m_ddev.create_bo(AMDXDNA_BO_DEV_HEAP, size);
+    try {
+      m_va = m_ddev.map_bo(m_hdl, size, size);
+    } catch (...) {
+      m_ddev.close_bo(m_hdl);
+      throw;
+    }
+  }
+
+  ~dev_heap()
+  {
+    munmap(m_va, size);
+    m_ddev.close_bo(m_hdl);
+  }
+
+private:
+  // Mapped at 64MB boundary, as the shim does
+  static constexpr size_t size = 64 << 20;
+  const drm_dev& m_ddev;
+  uint32_t m_hdl;
+  void *m_va;
+};
+
+// A context without anything on it, only for no-op jobs
+amdxdna_drm_create_ctx
+create_ctx(const drm_dev& ddev, device *dev)
+{
+  auto core_rows = device_query<query::aie_tiles_stats>(dev).core_rows;
+  return ddev.create_ctx(core_rows);
+}
+
+void
+attach_debug_bo(const drm_dev& ddev, uint32_t ctx, uint32_t hdl)
+{
+  amdxdna_drm_config_ctx arg = {};
+  arg.handle = ctx;
+  arg.param_type = DRM_AMDXDNA_CTX_ASSIGN_DBG_BUF;
+  arg.param_val = hdl;
+  ddev.ioctl_chk(DRM_IOCTL_AMDXDNA_CONFIG_CTX, &arg, "ASSIGN_DBG_BUF");
+}
+
+// Objects of the job cache and the generic kmalloc caches, the ones a
+// submission allocates from
+struct slab_counts {
+  // Allocations made so far with CONFIG_SLUB_STATS, objects in use otherwise
+  bool allocs = true;
+  int64_t job = 0;
+  int64_t kmalloc = 0;
+};
+
+bool
+is_counted_slab(const std::string& name)
+{
+  return name == "amdxdna_job" || name.rfind("kmalloc-", 0) == 0;
+}
+
+void
+count_slab(slab_counts& c, const std::string& name, int64_t n)
+{
+  if (name == "amdxdna_job")
+    c.job += n;
+  else
+    c.kmalloc += n;
+}
+
+// First number in a /sys/kernel/slab stat file, -1 if there is none
+int64_t
+read_slub_stat(const std::filesystem::path& path)
+{
+  int64_t n = -1;
+  std::ifstream(path) >> n;
+  return n;
+}
+
+// Returns false if neither SLUB stats nor /proc/slabinfo can be read
+bool
+read_slab_counts(slab_counts& c)
+{
+  std::error_code ec;
+  c = {};
+  for (const auto& e : std::filesystem::directory_iterator("/sys/kernel/slab", ec)) {
+    auto name = e.path().filename().string();
+    if (!is_counted_slab(name))
+      continue;
+    auto fast = read_slub_stat(e.path() / "alloc_fastpath");
+    auto slow = read_slub_stat(e.path() / "alloc_slowpath");
+    if (fast < 0 || slow < 0) {
+      c.allocs = false;
+      break;
+    }
+    count_slab(c, name, fast + slow);
+  }
+  if (!ec && c.allocs)
+    return true;
+
+  // Without SLUB stats, only objects in use can be told
+  c = {};
+  c.allocs = false;
+  std::ifstream slabinfo("/proc/slabinfo");
+  if (!slabinfo)
+    return false;
+  std::string line;
+  while (std::getline(slabinfo, line)) {
+    std::istringstream ls(line);
+    std::string name;
+    int64_t active = 0;
+    if ((ls >> name >> active) && is_counted_slab(name))
+      count_slab(c, name, active);
+  }
+  return true;
+}
+
+int
+create_bos(const drm_dev& ddev, std::vector<amdxdna_drm_create_bos_entry>& entries)
+{
+  amdxdna_drm_create_bos arg = {};
+  arg.entries = reinterpret_cast<uintptr_t>(entries.data());
+  arg.count = static_cast<uint32_t>(entries.size());
+  return ddev.ioctl(DRM_IOCTL_AMDXDNA_CREATE_BOS, &arg);
+}
+
+}
+
+void TEST_io_throughput(device::id_type, std::shared_ptr<device>, arg_type&);
+
+void
+TEST_sync_bos(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const size_t nbos = static_cast<size_t>(arg[0]);
+  const size_t size = 4096;
+  drm_dev ddev{sdev.get()};
+
+  std::vector<uint32_t> hdls;
+  std::vector<amdxdna_drm_sync_bo> entries;
+  for (size_t i = 0; i < nbos; i++) {
+    hdls.push_back(ddev.create_bo(AMDXDNA_BO_SHARE, size));
+    amdxdna_drm_sync_bo e = {};
+    e.handle = hdls.back();
+    e.direction = (i % 2) ? SYNC_DIRECT_FROM_DEVICE : SYNC_DIRECT_TO_DEVICE;
+    e.size = size;
+    entries.push_back(e);
+  }
+  auto syncobj = ddev.create_syncobj();
+
+  // Blocking
+  expect_errno(sync_bos(ddev, entries, 0, 0), 0, "Sync BOs");
+
+  // Async, syncobj point must signal
+  expect_errno(sync_bos(ddev, entries, syncobj, 1), 0, "Async sync BOs");
+  expect_errno(ddev.wait_syncobj(syncobj, 1, 3000), 0, "Wait for async sync BOs");
+
+  // One bad entry fails the whole request before anything is submitted,
+  // so the next point never gets a fence
+  auto bad = entries;
+  bad.back().offset = size;
+  expect_errno(sync_bos(ddev, bad, syncobj, 2), EINVAL, "Sync BOs with bad range");
+  bad = entries;
+  bad.back().handle = 0xffff;
+  expect_errno(sync_bos(ddev, bad, syncobj, 2), ENOENT, "Sync BOs with bad handle");
+  auto err = ddev.wait_syncobj(syncobj, 2, 100);
+  if (err != ETIME && err != EINVAL)
+    throw std::runtime_error("Failed sync BOs request added a fence, errno " + std::to_string(err));
+
+  // Flags are checked too
+  amdxdna_drm_sync_bos sarg = {};
+  sarg.entries = reinterpret_cast<uintptr_t>(entries.data());
+  sarg.count = static_cast<uint32_t>(entries.size());
+  sarg.syncobj = syncobj;
+  expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_SYNC_BOS, &sarg), EINVAL, "Sync BOs with syncobj but no async");
+
+  ddev.destroy_syncobj(syncobj);
+  for (auto h : hdls)
+    ddev.close_bo(h);
+}
+
+void
+TEST_sync_debug_bos(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const size_t nbos = static_cast<size_t>(arg[0]);
+  const size_t size = 4096;
+  drm_dev ddev{sdev.get()};
+  dev_heap heap{ddev};
+  auto actx = create_ctx(ddev, sdev.get()).handle;
+  auto bctx = create_ctx(ddev, sdev.get()).handle;
+
+  // Syncs from device of these go to the context as OP_SYNC_BO jobs
+  std::vector<uint32_t> hdls;
+  std::vector<amdxdna_drm_sync_bo> entries;
+  for (size_t i = 0; i < nbos; i++) {
+    hdls.push_back(ddev.create_bo(AMDXDNA_BO_DEV, size));
+    attach_debug_bo(ddev, actx, hdls.back());
+    amdxdna_drm_sync_bo e = {};
+    e.handle = hdls.back();
+    e.direction = SYNC_DIRECT_FROM_DEVICE;
+    e.size = size;
+    entries.push_back(e);
+  }
+  auto syncobj = ddev.create_syncobj();
+
+  // Blocking, all jobs are submitted before the last one is waited for
+  expect_errno(sync_bos(ddev, entries, 0, 0), 0, "Sync debug BOs");
+
+  // Async, syncobj point signals once the last job is done
+  expect_errno(sync_bos(ddev, entries, syncobj, 1), 0, "Async sync debug BOs");
+  expect_errno(ddev.wait_syncobj(syncobj, 1, 3000), 0, "Wait for async sync debug BOs");
+
+  // A BO whose context is gone passes the checks made before submission
+  // and fails when its turn comes, after the jobs of the entries before it
+  auto orphan = ddev.create_bo(AMDXDNA_BO_DEV, size);
+  attach_debug_bo(ddev, bctx, orphan);
+  ddev.destroy_ctx(bctx);
+  auto bad = entries;
+  bad.back().handle = orphan;
+  expect_errno(sync_bos(ddev, bad, 0, 0), EINVAL, "Sync debug BOs failing part way");
+
+  // Jobs submitted before the failure still get the point signaled
+  expect_errno(sync_bos(ddev, bad, syncobj, 2), EINVAL, "Async sync debug BOs failing part way");
+  expect_errno(ddev.wait_syncobj(syncobj, 2, 3000), 0, "Wait for async sync debug BOs failing part way");
+
+  // Context is still usable after that
+  expect_errno(sync_bos(ddev, entries, 0, 0), 0, "Sync debug BOs after failure");
+
+  ddev.destroy_syncobj(syncobj);
+  ddev.destroy_ctx(actx);
+  ddev.close_bo(orphan);
+  for (auto h : hdls)
+    ddev.close_bo(h);
+}
+
+void
+TEST_create_bos(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const size_t nbos = static_cast<size_t>(arg[0]);
+  const size_t size = 4096;
+  drm_dev ddev{sdev.get()};
+
+  std::vector<amdxdna_drm_create_bos_entry> entries(nbos);
+  for (size_t i = 0; i < nbos; i++) {
+    entries[i].size = size * (i + 1);
+    entries[i].type = (i % 2) ? AMDXDNA_BO_CMD : AMDXDNA_BO_SHARE;
+  }
+  expect_errno(create_bos(ddev, entries), 0, "Create BOs");
+
+  // Same as what GET_BO_INFO tells about each BO
+  uint32_t max_hdl = 0;
+  for (auto& e : entries) {
+    amdxdna_drm_get_bo_info info = {};
+    info.handle = e.handle;
+    ddev.ioctl_chk(DRM_IOCTL_AMDXDNA_GET_BO_INFO, &info, "GET_BO_INFO");
+    if (info.map_offset != e.map_offset || info.vaddr != e.vaddr || info.xdna_addr != e.xdna_addr)
+      throw std::runtime_error("BO " + std::to_string(e.handle) + " info mismatch");
+    max_hdl = std::max(max_hdl, e.handle);
+  }
+
+  // One bad entry at the end, BOs created before it must be gone again
+  auto bad = entries;
+  bad.back().type = AMDXDNA_BO_DEV_HEAP;
+  expect_errno(create_bos(ddev, bad), EINVAL, "Create BOs with bad type");
+  for (uint32_t h = max_hdl + 1; h < max_hdl + nbos; h++) {
+    amdxdna_drm_get_bo_info info = {};
+    info.handle = h;
+    expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_GET_BO_INFO, &info), ENOENT, "Leftover BO of failed batch");
+  }
+
+  for (auto& e : entries)
+    ddev.close_bo(e.handle);
+}
+
+void
+TEST_submit_area(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const size_t area_size = 4096;
+  drm_dev ddev{sdev.get()};
+  dev_heap heap{ddev};
+
+  auto area_hdl = ddev.create_bo(AMDXDNA_BO_DEV, area_size);
+  auto area = reinterpret_cast<char *>(ddev.get_bo_info(area_hdl).vaddr);
+  auto cctx = create_ctx(ddev, sdev.get());
+  auto ctx = cctx.handle;
+
+  amdxdna_drm_config_ctx carg = {};
+  carg.handle = ctx;
+  carg.param_type = DRM_AMDXDNA_CTX_ASSIGN_SUBMIT_AREA;
+  carg.param_val = area_hdl;
+  ddev.ioctl_chk(DRM_IOCTL_AMDXDNA_CONFIG_CTX, &carg, "ASSIGN_SUBMIT_AREA");
+  expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_CONFIG_CTX, &carg), EBUSY, "Assign second submit area");
+
+  // One signaled wait point right after the header
+  auto syncobj = ddev.create_syncobj();
+  ddev.signal_syncobj(syncobj, 1);
+  auto hdr = reinterpret_cast<amdxdna_submit_area_hdr *>(area);
+  const size_t pts_off = sizeof(*hdr);
+  const size_t hdls_off = pts_off + sizeof(uint64_t);
+  *reinterpret_cast<uint64_t *>(area + pts_off) = 1;
+  *reinterpret_cast<uint32_t *>(area + hdls_off) = syncobj;
+  __atomic_store_n(&hdr->generation, 5, __ATOMIC_RELEASE);
+
+  amdxdna_drm_exec_cmd ecmd = {};
+  ecmd.ext_flags = AMDXDNA_EXEC_FLAG_SUBMIT_AREA;
+  ecmd.ctx = ctx;
+  ecmd.type = AMDXDNA_CMD_SUBMIT_DEPENDENCY;
+  ecmd.cmd_handles = hdls_off;
+  ecmd.args = pts_off;
+  ecmd.cmd_count = 1;
+  ecmd.arg_count = 1;
+
+  // Arrays published under another generation are not used
+  ecmd.seq = 4;
+  expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &ecmd), ESTALE, "Submit with stale area");
+
+  // Arrays out of the area or overlapping the header are rejected
+  auto bad = ecmd;
+  bad.seq = 5;
+  bad.cmd_handles = area_size;
+  expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &bad), EINVAL, "Submit with array out of area");
+  bad = ecmd;
+  bad.seq = 5;
+  bad.args = 0;
+  expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &bad), EINVAL, "Submit with array in area header");
+
+  ecmd.seq = 5;
+  expect_errno(ddev.ioctl(DRM_IOCTL_AMDXDNA_EXEC_CMD, &ecmd), 0, "Submit with area");
+  expect_errno(ddev.wait_syncobj(cctx.syncobj_handle, ecmd.seq, 3000), 0, "Wait for dependency");
+
+  ddev.destroy_syncobj(syncobj);
+  ddev.destroy_ctx(ctx);
+  ddev.close_bo(area_hdl);
+}
+
+void
+TEST_io_slab_allocs(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const uint64_t total = arg[0];
+  slab_counts probe;
+
+  if (!read_slab_counts(probe)) {
+    std::cout << "Reading slab counts needs root, skipped" << std::endl;
+    return;
+  }
+
+  auto run = [&](uint64_t n) {
+    slab_counts before, after;
+    read_slab_counts(before);
+    TEST_io_throughput(id, sdev, { IO_TEST_NOOP_RUN, IO_TEST_IOCTL_WAIT, n });
+    read_slab_counts(after);
+    return std::make_pair(after.job - before.job, after.kmalloc - before.kmalloc);
+  };
+
+  // Setup allocates the same for both runs, the difference is what the
+  // extra commands cost
+  auto once = run(total);
+  auto twice = run(2 * total);
+  auto job = static_cast<double>(twice.first - once.first) / total;
+  auto kmalloc = static_cast<double>(twice.second - once.second) / total;
+
+  std::cout << (probe.allocs ? "Allocations" : "Objects in use (no CONFIG_SLUB_STATS)")
+            << " per command: amdxdna_job " << job << ", kmalloc-* " << kmalloc << std::endl;
+  // System wide kmalloc counts are noisy and the job cache may be merged
+  // with another one, only check that every command takes a job from it
+  if (probe.allocs && job < 0.9)
+    throw std::runtime_error("Commands are not allocating jobs from amdxdna_job");
+}
+
+void
+TEST_client_budget(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const uint32_t pct = static_cast<uint32_t>(arg[0]);
+  drm_dev ddev{sdev.get()};
+
+  auto err = set_client_budget(ddev, pct);
+  if (err == EPERM || err == EACCES) {
+    std::cout << "Setting client budget needs root, skipped" << std::endl;
+    return;
+  }
+  expect_errno(err, 0, "Set client budget");
+
+  try {
+    auto start = clk::now();
+    TEST_io_throughput(id, sdev, { IO_TEST_NOOP_RUN, IO_TEST_IOCTL_WAIT, arg[1] });
+    auto wall_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<ns_t>(clk::now() - start).count());
+
+    bool busy = false;
+    for (auto& u : get_client_usage(ddev)) {
+      if (u.budget_pct != pct || u.allotted_ns != u.period_ns * pct / 100)
+        throw std::runtime_error("Client budget is not what was set");
+      if (!u.busy_ns)
+        continue;
+      busy = true;
+      // Far more busy time than the budget allows means it was never enforced
+      if (u.busy_ns > wall_ns * pct / 100 + 2 * u.period_ns && !u.throttled_ns)
+        throw std::runtime_error("Client went over budget without being throttled");
+      std::cout << "Client busy " << u.busy_ns << " ns in " << wall_ns << " ns, "
+                << "throttled " << u.throttled_ns << " ns" << std::endl;
+    }
+    if (!busy)
+      throw std::runtime_error("No busy time charged to the client");
+  } catch (...) {
+    set_client_budget(ddev, 0);
+    throw;
+  }
+
+  // Without budget nothing is charged to the period any more
+  expect_errno(set_client_budget(ddev, 0), 0, "Remove client budget");
+  for (auto& u : get_client_usage(ddev)) {
+    if (u.budget_pct || u.period_busy_ns || u.allotted_ns)
+      throw std::runtime_error("Client still has budget after removing it");
+  }
+}
+
+void
+TEST_ctx_status(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  const unsigned int total = static_cast<unsigned int>(arg[0]);
+  const size_t page_size = getpagesize();
+  drm_dev ddev{sdev.get()};
+  dev_heap heap{ddev};
+
+  auto cctx = create_ctx(ddev, sdev.get());
+  if (!cctx.status_offset) {
+    std::cout << "Context status page not supported, skipped" << std::endl;
+    ddev.destroy_ctx(cctx.handle);
+    return;
+  }
+
+  // Driver owns the page, it can't be made writable
+  if (ddev.map(page_size, PROT_READ | PROT_WRITE, cctx.status_offset) != MAP_FAILED)
+    throw std::runtime_error("Status page mapped writable");
+  auto page = ddev.map(page_size, PROT_READ, cctx.status_offset);
+  if (page == MAP_FAILED)
+    throw std::runtime_error("Failed to map status page, errno " + std::to_string(errno));
+  if (!mprotect(page, page_size, PROT_READ | PROT_WRITE))
+    throw std::runtime_error("Status page made writable");
+  auto status = static_cast<const amdxdna_ctx_status *>(page);
+
+  // No-op jobs depending on a signaled point
+  auto syncobj = ddev.create_syncobj();
+  ddev.signal_syncobj(syncobj, 1);
+  uint64_t point = 1;
+  amdxdna_drm_exec_cmd ecmd = {};
+  for (unsigned int i = 0; i < total; i++) {
+    ecmd = {};
+    ecmd.ctx = cctx.handle;
+    ecmd.type = AMDXDNA_CMD_SUBMIT_DEPENDENCY;
+    ecmd.cmd_handles = reinterpret_cast<uintptr_t>(&syncobj);
+    ecmd.args = reinterpret_cast<uintptr_t>(&point);
+    ecmd.cmd_count = 1;
+    ecmd.arg_count = 1;
+    ddev.ioctl_chk(DRM_IOCTL_AMDXDNA_EXEC_CMD, &ecmd, "EXEC_CMD");
+  }
+  expect_errno(ddev.wait_syncobj(cctx.syncobj_handle, ecmd.seq, 3000), 0, "Wait for no-op jobs");
+
+  // Consistent snapshot of the page
+  auto read_status = [status] {
+    amdxdna_ctx_status snap = {};
+    uint32_t seq;
+    do {
+      seq = __atomic_load_n(&status->seq, __ATOMIC_ACQUIRE);
+      snap.completed = __atomic_load_n(&status->completed, __ATOMIC_RELAXED);
+      snap.submitted = __atomic_load_n(&status->submitted, __ATOMIC_RELAXED);
+      snap.errors = __atomic_load_n(&status->errors, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&status->seq, __ATOMIC_RELAXED));
+    return snap;
+  };
+
+  // Counters are published right after the fence is signaled
+  auto snap = read_status();
+  auto deadline = clk::now() + std::chrono::seconds(1);
+  while (snap.completed < total && clk::now() < deadline)
+    snap = read_status();
+
+  if (snap.submitted != total || snap.completed != total || snap.errors)
+    throw std::runtime_error("Status page " + std::to_string(snap.submitted) + "/" +
+      std::to_string(snap.completed) + "/" + std::to_string(snap.errors) +
+      ", expecting " + std::to_string(total) + " submitted and completed");
+
+  // Same as what HW_CONTEXTS query tells about this context
+  auto ctxs = ddev.get_hw_contexts();
+  auto it = std::find_if(ctxs.begin(), ctxs.end(), [&cctx](const auto& c) {
+    return c.pid == getpid() && c.context_id == cctx.handle;
+  });
+  if (it == ctxs.end())
+    throw std::runtime_error("Context not found in HW contexts");
+  if (it->command_submissions != snap.submitted || it->command_completions != snap.completed ||
+      it->errors != snap.errors)
+    throw std::runtime_error("Status page differs from HW contexts");
+
+  munmap(page, page_size);
+  ddev.destroy_syncobj(syncobj);
+  ddev.destroy_ctx(cctx.handle);
+}
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+// Tests of virtual HW contexts, only meaningful with Debug.xdna_virtual_hwctx
+// set, see TEST_virt_hwctx_ini()
+
+#include "io.h"
+#include "hwctx.h"
+#include "drm_dev.h"
+#include "ini_proc.h"
+
+#include "core/common/config_reader.h"
+#include "core/common/shim/fence_handle.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using namespace xrt_core;
+using arg_type = const std::vector<uint64_t>;
+
+// A no-op command ready to be submitted to a context
+struct noop_cmd {
+  io_test_bo_set boset;
+  std::shared_ptr<bo> cbo;
+  ert_start_kernel_cmd *cpkt;
+
+  noop_cmd(device *dev, hw_ctx& ctx) : boset{dev}
+  {
+    init_noop_cmd(boset, ctx.get(), dev);
+    cbo = boset.get_bos()[IO_TEST_BO_CMD].tbo;
+    cpkt = reinterpret_cast<ert_start_kernel_cmd *>(cbo->map());
+  }
+
+  void
+  run(hw_ctx& ctx)
+  {
+    auto hwq = ctx.get()->get_hw_queue();
+    hwq->submit_command(cbo->get());
+    hwq->wait_command(cbo->get(), 0);
+    check_and_reset_cmd(cpkt);
+  }
+};
+
+// Contexts this process has on the device, as driver sees them
+size_t
+num_device_contexts(const drm_dev& ddev)
+{
+  auto ctxs = ddev.get_hw_contexts();
+  return std::count_if(ctxs.begin(), ctxs.end(),
+    [](const auto& c) { return c.pid == getpid(); });
+}
+
+void
+expect_device_contexts(const drm_dev& ddev, size_t expected, const std::string& when)
+{
+  auto n = num_device_contexts(ddev);
+  if (n != expected) {
+    throw std::runtime_error(std::to_string(n) + " contexts on device " + when +
+      ", expecting " + std::to_string(expected));
+  }
+}
+
+}
+
+void
+TEST_virt_hwctx_share_slot(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  auto num = static_cast<size_t>(arg[0]);
+  drm_dev ddev{dev};
+  std::vector<std::unique_ptr<hw_ctx>> ctxs;
+
+  for (size_t i = 0; i < num; i++)
+    ctxs.push_back(std::make_unique<hw_ctx>(dev));
+
+  auto slot = ctxs[0]->get()->get_slotidx();
+  for (auto& ctx : ctxs) {
+    if (ctx->get()->get_slotidx() != slot)
+      throw std::runtime_error("Virtual contexts on different slots");
+  }
+  expect_device_contexts(ddev, 1, "with " + std::to_string(num) + " virtual contexts");
+
+  // Each of them runs commands on the shared one
+  for (auto& ctx : ctxs) {
+    noop_cmd cmd{dev, *ctx};
+    cmd.run(*ctx);
+  }
+}
+
+void
+TEST_virt_hwctx_completion(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  auto total = static_cast<unsigned int>(arg[0]);
+  hw_ctx actx{dev};
+  hw_ctx bctx{dev};
+  noop_cmd acmd{dev, actx};
+  noop_cmd bcmd{dev, bctx};
+  auto aq = actx.get()->get_hw_queue();
+  auto bq = bctx.get()->get_hw_queue();
+
+  // Both in flight on the shared queue, each context waits for its own,
+  // the later one first
+  for (unsigned int i = 0; i < total; i++) {
+    aq->submit_command(acmd.cbo->get());
+    bq->submit_command(bcmd.cbo->get());
+    if (!bq->wait_command(bcmd.cbo->get(), 0))
+      throw std::runtime_error("Second virtual context command not done");
+    if (!aq->wait_command(acmd.cbo->get(), 0))
+      throw std::runtime_error("First virtual context command not done");
+    check_and_reset_cmd(bcmd.cpkt);
+    check_and_reset_cmd(acmd.cpkt);
+  }
+}
+
+void
+TEST_virt_hwctx_inflight_cap(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  auto cap = xrt_core::config::detail::get_uint_value("Debug.xdna_virtual_hwctx_inflight", 4);
+  hw_ctx actx{dev};
+  hw_ctx bctx{dev};
+  auto aq = actx.get()->get_hw_queue();
+  auto bq = bctx.get()->get_hw_queue();
+
+  std::vector<std::unique_ptr<noop_cmd>> acmds;
+  for (unsigned int i = 0; i <= cap; i++)
+    acmds.push_back(std::make_unique<noop_cmd>(dev, actx));
+  noop_cmd bcmd{dev, bctx};
+
+  // Hold the shared queue behind an unsignaled fence
+  auto sfence = dev->create_fence(fence_handle::access_mode::process);
+  auto wfence = sfence->clone();
+  aq->submit_wait(wfence.get());
+  for (unsigned int i = 0; i < cap; i++)
+    aq->submit_command(acmds[i]->cbo->get());
+
+  // One more blocks until the first one is done
+  std::atomic<bool> submitted{false};
+  std::thread t([&] {
+    aq->submit_command(acmds[cap]->cbo->get());
+    submitted = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  bool blocked = !submitted;
+
+  // Another virtual context is not held back by the cap of the first
+  bq->submit_command(bcmd.cbo->get());
+
+  sfence->signal();
+  t.join();
+  if (!blocked)
+    throw std::runtime_error("Submission over in-flight cap did not wait");
+
+  for (auto& c : acmds) {
+    aq->wait_command(c->cbo->get(), 0);
+    check_and_reset_cmd(c->cpkt);
+  }
+  bq->wait_command(bcmd.cbo->get(), 0);
+  check_and_reset_cmd(bcmd.cpkt);
+}
+
+void
+TEST_virt_hwctx_teardown(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  drm_dev ddev{dev};
+
+  auto actx = std::make_unique<hw_ctx>(dev);
+  auto bctx = std::make_unique<hw_ctx>(dev);
+  expect_device_contexts(ddev, 1, "with two virtual contexts");
+
+  // Shared context stays while one user is left
+  actx.reset();
+  expect_device_contexts(ddev, 1, "after closing first virtual context");
+  {
+    noop_cmd cmd{dev, *bctx};
+    cmd.run(*bctx);
+  }
+
+  // And goes with the last one
+  bctx.reset();
+  expect_device_contexts(ddev, 0, "after closing all virtual contexts");
+
+  // A new one gets a new shared context
+  hw_ctx cctx{dev};
+  expect_device_contexts(ddev, 1, "after reopening");
+  noop_cmd cmd{dev, cctx};
+  cmd.run(cctx);
+}
+
+void
+TEST_virt_hwctx_ini(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto ini = "[Debug]\nxdna_virtual_hwctx=true\nxdna_virtual_hwctx_inflight=" +
+    std::to_string(arg[0]) + "\n";
+
+  run_with_ini(ini, "virtual HW contexts share one slot (xrt.ini)");
+  run_with_ini(ini, "virtual HW contexts complete own commands (xrt.ini)");
+  run_with_ini(ini, "virtual HW context in-flight cap (xrt.ini)");
+  run_with_ini(ini, "virtual HW contexts last user tears down (xrt.ini)");
+}
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+// Tests of completion callbacks, which are only reachable through the shim's
+// own HW queue class, so this file is built against the shim headers
+
+#include "io.h"
+#include "hwctx.h"
+#include "../../src/shim/hwq.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using arg_type = const std::vector<uint64_t>;
+
+shim_xdna::hw_q *
+get_shim_hwq(hw_ctx& ctx)
+{
+  auto hwq = dynamic_cast<shim_xdna::hw_q *>(ctx.get()->get_hw_queue());
+  if (!hwq)
+    throw std::runtime_error("HW queue is not an XDNA shim queue");
+  return hwq;
+}
+
+// Completions seen by the callbacks of one test
+struct completions {
+  std::mutex lock;
+  std::condition_variable cv;
+  std::vector<size_t> order;
+  std::vector<ert_cmd_state> states;
+  std::thread::id reaper;
+  bool one_thread = true;
+
+  shim_xdna::hw_q::completion_callback
+  callback(size_t idx)
+  {
+    return [this, idx](xrt_core::buffer_handle *, ert_cmd_state state) {
+      std::lock_guard<std::mutex> l(lock);
+      if (order.empty())
+        reaper = std::this_thread::get_id();
+      else if (reaper != std::this_thread::get_id())
+        one_thread = false;
+      order.push_back(idx);
+      states.push_back(state);
+      cv.notify_all();
+    };
+  }
+
+  bool
+  wait_for(size_t n, uint32_t timeout_ms)
+  {
+    std::unique_lock<std::mutex> l(lock);
+    return cv.wait_for(l, std::chrono::milliseconds(timeout_ms), [&] { return order.size() >= n; });
+  }
+};
+
+}
+
+void
+TEST_cmd_callbacks(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  auto inflight = static_cast<size_t>(arg[0]);
+  auto rounds = static_cast<size_t>(arg[1]);
+  hw_ctx ctx{dev};
+  auto hwq = get_shim_hwq(ctx);
+
+  std::vector<std::unique_ptr<io_test_bo_set>> bosets;
+  std::vector<bo *> cbos;
+  for (size_t i = 0; i < inflight; i++) {
+    bosets.push_back(std::make_unique<io_test_bo_set>(dev));
+    init_noop_cmd(*bosets.back(), ctx.get(), dev);
+    cbos.push_back(bosets.back()->get_bos()[IO_TEST_BO_CMD].tbo.get());
+  }
+
+  // Nobody but the reaper waits for the commands
+  completions c;
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < inflight; i++)
+      hwq->submit_command(cbos[i]->get(), c.callback(r * inflight + i));
+    if (!c.wait_for((r + 1) * inflight, 3000))
+      throw std::runtime_error("Callbacks missing after round " + std::to_string(r));
+    for (auto cbo : cbos)
+      check_and_reset_cmd(reinterpret_cast<ert_start_kernel_cmd *>(cbo->map()));
+  }
+
+  for (size_t i = 0; i < c.order.size(); i++) {
+    if (c.order[i] != i)
+      throw std::runtime_error("Callback " + std::to_string(c.order[i]) + " out of order");
+    if (c.states[i] != ERT_CMD_STATE_COMPLETED)
+      throw std::runtime_error("Callback got state " + std::to_string(c.states[i]));
+  }
+  if (!c.one_thread || c.reaper == std::this_thread::get_id())
+    throw std::runtime_error("Callbacks did not all run on one reaper thread");
+
+  // Stopping the reaper with commands in flight does not hang, and every
+  // command still gets its callback
+  completions s;
+  for (size_t i = 0; i < inflight; i++)
+    hwq->submit_command(cbos[i]->get(), s.callback(i));
+  auto start = std::chrono::steady_clock::now();
+  hwq->stop_reaper();
+  auto stop_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  if (s.order.size() != inflight)
+    throw std::runtime_error("Stopping the reaper dropped callbacks");
+  // One wait step plus running the callbacks
+  if (stop_ms > 1000)
+    throw std::runtime_error("Stopping the reaper took " + std::to_string(stop_ms) + "ms");
+  for (auto cbo : cbos)
+    hwq->wait_command(cbo->get(), 0);
+}
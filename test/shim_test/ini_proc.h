@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2025, Advanced Micro Devices, Inc. All rights reserved.
+
+#ifndef _SHIMTEST_INI_PROC_H_
+#define _SHIMTEST_INI_PROC_H_
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Shim reads xrt.ini settings once per process. To test with a setting
+// toggled, run the test case by name in a new shim_test process which is
+// pointed to an xrt.ini holding the given content.
+inline void
+run_with_ini(const std::string& ini, const std::string& test_name)
+{
+  char tmpl[] = "/tmp/shim_test_ini_XXXXXX";
+  if (!mkdtemp(tmpl))
+    throw std::runtime_error("Failed to create temp dir for xrt.ini");
+  auto dir = std::filesystem::path(tmpl);
+  auto ini_path = dir / "xrt.ini";
+  std::ofstream(ini_path) << ini;
+
+  auto exe = std::filesystem::read_symlink("/proc/self/exe").string();
+  std::cout << "Running '" << test_name << "' with xrt.ini:\n" << ini << std::flush;
+  auto pid = fork();
+  if (pid == 0) {
+    setenv("XRT_INI_PATH", ini_path.c_str(), 1);
+    execl(exe.c_str(), exe.c_str(), test_name.c_str(), nullptr);
+    _exit(127);
+  }
+
+  int status = 0;
+  if (pid > 0)
+    waitpid(pid, &status, 0);
+  std::filesystem::remove_all(dir);
+
+  if (pid < 0)
+    throw std::runtime_error("Failed to fork test process");
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    throw std::runtime_error("'" + test_name + "' failed with xrt.ini setting");
+}
+
+#endif // _SHIMTEST_INI_PROC_H_
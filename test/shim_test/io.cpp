@@ -401,3 +401,28 @@ get_bos()
 {
   return m_bo_array;
 }
+
+void
+init_noop_cmd(io_test_bo_set& boset, hwctx_handle *hwctx, device *dev)
+{
+  auto& bos = boset.get_bos();
+  size_t sz = 32 * sizeof(int32_t);
+  auto tbo = std::make_shared<bo>(dev, sz, XCL_BO_FLAGS_CACHEABLE);
+
+  bos[IO_TEST_BO_INSTRUCTION].tbo = tbo;
+  std::memset(tbo->map(), 0, sz);
+
+  auto kernel = get_kernel_name(dev, nullptr);
+  if (kernel.empty())
+    throw std::runtime_error("No kernel found");
+  boset.init_cmd(hwctx->open_cu_context(kernel), false);
+  boset.sync_before_run();
+}
+
+void
+check_and_reset_cmd(ert_start_kernel_cmd *cpkt)
+{
+  if (cpkt->state != ERT_CMD_STATE_COMPLETED)
+    throw std::runtime_error(std::string("Command failed, state=") + std::to_string(cpkt->state));
+  cpkt->state = ERT_CMD_STATE_NEW;
+}
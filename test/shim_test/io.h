@@ -7,6 +7,8 @@
 #include "bo.h"
 
 #include "core/common/device.h"
+#include "core/common/shim/hwctx_handle.h"
+#include "core/include/ert.h"
 #include <memory>
 
 enum io_test_bo_type {
@@ -102,4 +104,12 @@ private:
   std::string m_elf_path;
 };
 
+// Set up boset to run the no-op kernel, with an all zero instruction buffer
+void
+init_noop_cmd(io_test_bo_set& boset, xrt_core::hwctx_handle *hwctx, device *dev);
+
+// Throw if the command did not complete, make it ready to submit again if it did
+void
+check_and_reset_cmd(ert_start_kernel_cmd *cpkt);
+
 #endif // _SHIMTEST_IO_H_
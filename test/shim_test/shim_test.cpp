@@ -12,12 +12,16 @@
 #include "hwctx.h"
 #include "speed.h"
 #include "bo.h"
+#include "ini_proc.h"
+#include "device_group.h"
 
 #include "core/common/query_requests.h"
 #include "core/common/sysinfo.h"
 #include "core/common/system.h"
 #include "core/common/device.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <vector>
@@ -56,6 +60,21 @@ void TEST_shim_umq_remote_barrier(device::id_type, std::shared_ptr<device>, arg_
 void TEST_elf_io(device::id_type, std::shared_ptr<device>, arg_type&);
 void TEST_cmd_fence_host(device::id_type, std::shared_ptr<device>, arg_type&);
 void TEST_cmd_fence_device(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_cmd_fence_pipeline_latency(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_cmd_wait_timeout_loop(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_sync_bos(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_sync_debug_bos(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_io_slab_allocs(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_cmd_callbacks(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_create_bos(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_submit_area(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_client_budget(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_ctx_status(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_virt_hwctx_share_slot(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_virt_hwctx_completion(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_virt_hwctx_inflight_cap(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_virt_hwctx_teardown(device::id_type, std::shared_ptr<device>, arg_type&);
+void TEST_virt_hwctx_ini(device::id_type, std::shared_ptr<device>, arg_type&);
 
 inline void
 set_xrt_path()
@@ -283,6 +302,38 @@ TEST_create_destroy_hw_context(device::id_type id, std::shared_ptr<device> sdev,
   }
 }
 
+void
+TEST_create_destroy_hw_context_perf(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto dev = sdev.get();
+  auto iters = static_cast<int>(arg[0]);
+  // PDIs are registered per CU, run with -x to pick a xclbin of 1, 4 or 8 CUs
+  auto num_cus = get_xclbin_ip_name2index(dev).size();
+
+  auto start = clk::now();
+  for (int i = 0; i < iters; i++)
+    hw_ctx hwctx{dev};
+  auto end = clk::now();
+
+  auto dur = std::chrono::duration_cast<us_t>(end - start).count();
+  std::cout << "\t" << num_cus << " CU(s), " << iters << " context create/destroy: "
+    << (dur / iters) << "us each" << std::endl;
+}
+
+void
+TEST_query_telemetry_perf(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto iters = static_cast<int>(arg[0]);
+
+  auto start = clk::now();
+  for (int i = 0; i < iters; i++)
+    device_query<query::aie_telemetry>(sdev);
+  auto end = clk::now();
+
+  auto dur = std::chrono::duration_cast<us_t>(end - start).count();
+  std::cout << "\t" << iters << " telemetry queries: " << (dur / iters) << "us each" << std::endl;
+}
+
 void
 TEST_create_destroy_virtual_context(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
 {
@@ -320,6 +371,61 @@ TEST_multi_context_io_test(device::id_type id, std::shared_ptr<device> sdev, arg
   threads.run_test(id, std::move(sdev), {IO_TEST_NORMAL_RUN, IO_TEST_IOCTL_WAIT, 3000});
 }
 
+void
+TEST_io_latency_with_query_pollers(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto num_submitters = static_cast<int>(arg[0]);
+  auto num_pollers = static_cast<int>(arg[1]);
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> queries{0};
+  std::vector<std::thread> pollers;
+
+  // xrt-smi style pollers of read-only device info racing with submitters
+  for (int i = 0; i < num_pollers; i++) {
+    pollers.emplace_back([&] {
+      while (!stop) {
+        device_query<query::aie_partition_info>(sdev);
+        device_query<query::clock_freq_topology_raw>(sdev);
+        queries += 2;
+      }
+    });
+  }
+
+  auto start = clk::now();
+  multi_thread submitters(num_submitters, TEST_io_latency);
+  submitters.run_test(id, sdev, {IO_TEST_NOOP_RUN, IO_TEST_IOCTL_WAIT, arg[2]});
+  auto end = clk::now();
+
+  stop = true;
+  for (auto& t : pollers)
+    t.join();
+
+  auto dur = std::chrono::duration_cast<us_t>(end - start).count();
+  std::cout << "\t" << num_pollers << " poller(s): " << (queries * 1000000.0 / dur)
+    << " queries/sec" << std::endl;
+}
+
+void
+TEST_device_group_spread(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto num_ctx = arg[0];
+  auto group = shim_xdna::device_group::all();
+  xrt::xclbin xclbin(get_xclbin_path(sdev.get()));
+  xrt::hw_context::qos_type qos{ {"gops", 100} };
+  std::vector<std::unique_ptr<hwctx_handle>> ctxs;
+
+  for (uint64_t i = 0; i < num_ctx; i++) {
+    auto [dev, ctx] = group.create_hw_context(xclbin, qos, xrt::hw_context::access_mode::shared);
+    std::cout << "\tcontext " << i << " on device " << dev->get_device_id() << std::endl;
+    ctxs.push_back(std::move(ctx));
+  }
+
+  for (const auto& l : group.get_load()) {
+    std::cout << "\tdevice " << l.id << ": " << l.busy_cols << "/" << l.total_cols
+      << " cols busy, " << l.contexts << " contexts, " << l.queued << " queued" << std::endl;
+  }
+}
+
 void
 TEST_create_free_debug_bo(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
 {
@@ -379,6 +485,56 @@ TEST_create_free_bo(device::id_type id, std::shared_ptr<device> sdev, arg_type&
     get_and_show_bo_properties(dev, bo->get());
 }
 
+void
+TEST_contiguous_bo_map_ini(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  // PDI BOs of a HW context are created in one batch and mapped in one range
+  run_with_ini("[Debug]\nxdna_contiguous_bo_map=true\n", "io test real kernel good run");
+}
+
+void
+TEST_cmd_fence_submit_area_ini(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  // Args and waits passed in the submit area and by user pointers
+  for (auto on : { "true", "false" }) {
+    run_with_ini(std::string("[Debug]\nxdna_submit_area=") + on + "\n",
+      "measure no-op kernel latency across two contexts with cmd fence");
+  }
+}
+
+void
+create_free_bo_loop(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto boflags = static_cast<unsigned int>(arg[0]);
+  auto ext_boflags = static_cast<unsigned int>(arg[1]);
+  auto size = static_cast<size_t>(arg[2]);
+  auto iters = static_cast<int>(arg[3]);
+
+  for (int i = 0; i < iters; i++)
+    bo bo{sdev.get(), size, boflags, ext_boflags};
+}
+
+void
+TEST_create_free_bo_multi_thread_perf(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
+{
+  auto iters = arg[3];
+  // Keep the heap alive so that its alloc/free is not part of the measurement
+  bo heap_holder{sdev.get(), static_cast<size_t>(arg[2]),
+    static_cast<unsigned int>(arg[0]), static_cast<unsigned int>(arg[1])};
+
+  for (int threads : { 1, 2, 4, 8 }) {
+    multi_thread threads_runner(threads, create_free_bo_loop);
+
+    auto start = clk::now();
+    threads_runner.run_test(id, sdev, arg);
+    auto end = clk::now();
+
+    auto dur = std::chrono::duration_cast<us_t>(end - start).count();
+    std::cout << "\t" << threads << " thread(s), " << iters << " alloc/free each: "
+      << dur << "us, " << (threads * iters * 1000000.0 / dur) << " ops/sec" << std::endl;
+  }
+}
+
 void
 TEST_sync_bo(device::id_type id, std::shared_ptr<device> sdev, arg_type& arg)
 {
@@ -687,6 +843,12 @@ std::vector<test_case> test_list {
   test_case{ "Cmd fencing (driver side)", {-1, -1},
     TEST_POSITIVE, dev_filter_is_aie2, TEST_cmd_fence_device, {}
   },
+  test_case{ "measure no-op kernel latency across two contexts with cmd fence", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_cmd_fence_pipeline_latency, { 1000 }
+  },
+  test_case{ "measure timed out command wait loop overhead", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_cmd_wait_timeout_loop, { 1000 }
+  },
   test_case{ "sync_bo for input_output 1MiB BO", {},
     TEST_POSITIVE, dev_filter_xdna, TEST_sync_bo, {XCL_BO_FLAGS_HOST_ONLY, 0, 0x100000}
   },
@@ -732,6 +894,68 @@ std::vector<test_case> test_list {
   test_case{ "Create and destroy devices", {},
     TEST_POSITIVE, dev_filter_is_aie2, TEST_create_destroy_device, {}
   },
+  test_case{ "measure multi-thread dev bo alloc/free", {},
+    TEST_POSITIVE, dev_filter_xdna, TEST_create_free_bo_multi_thread_perf,
+    {XCL_BO_FLAGS_CACHEABLE, 0, 0x1000, 1000}
+  },
+  test_case{ "measure hw context create/destroy latency", {},
+    TEST_POSITIVE, dev_filter_is_aie, TEST_create_destroy_hw_context_perf, {20}
+  },
+  test_case{ "measure telemetry query latency", {},
+    TEST_POSITIVE, dev_filter_xdna, TEST_query_telemetry_perf, {1000}
+  },
+  test_case{ "measure no-op kernel latency with concurrent query pollers", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_io_latency_with_query_pollers, {2, 4, 8000}
+  },
+  test_case{ "spread hw contexts over device group", {},
+    TEST_POSITIVE, dev_filter_xdna, TEST_device_group_spread, {4}
+  },
+  test_case{ "sync BOs in batch, blocking, async and failing", {},
+    TEST_POSITIVE, dev_filter_xdna, TEST_sync_bos, {8}
+  },
+  test_case{ "sync debug BOs of a context in batch, blocking, async and failing", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_sync_debug_bos, {8}
+  },
+  test_case{ "create BOs in batch", {},
+    TEST_POSITIVE, dev_filter_xdna, TEST_create_bos, {8}
+  },
+  test_case{ "run kernel with PDI BOs mapped in one range", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_contiguous_bo_map_ini, {}
+  },
+  test_case{ "submit through submit area, stale and bad arrays", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_submit_area, {}
+  },
+  test_case{ "cmd fence with submit area on and off", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_cmd_fence_submit_area_ini, {}
+  },
+  test_case{ "run no-op kernel under client budget", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_client_budget, { 10, 32000 }
+  },
+  test_case{ "measure slab allocations per no-op command", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_io_slab_allocs, { 32000 }
+  },
+  test_case{ "completion callbacks in order from one reaper thread", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_cmd_callbacks, { 64, 16 }
+  },
+  test_case{ "context status page matches HW contexts query", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_ctx_status, { 100 }
+  },
+  // Only run in the process started by the last test case below
+  test_case{ "virtual HW contexts share one slot (xrt.ini)", {},
+    TEST_POSITIVE, skip_dev_filter, TEST_virt_hwctx_share_slot, { 4 }
+  },
+  test_case{ "virtual HW contexts complete own commands (xrt.ini)", {},
+    TEST_POSITIVE, skip_dev_filter, TEST_virt_hwctx_completion, { 100 }
+  },
+  test_case{ "virtual HW context in-flight cap (xrt.ini)", {},
+    TEST_POSITIVE, skip_dev_filter, TEST_virt_hwctx_inflight_cap, {}
+  },
+  test_case{ "virtual HW contexts last user tears down (xrt.ini)", {},
+    TEST_POSITIVE, skip_dev_filter, TEST_virt_hwctx_teardown, {}
+  },
+  test_case{ "virtual HW contexts", {},
+    TEST_POSITIVE, dev_filter_is_aie2, TEST_virt_hwctx_ini, { 2 }
+  },
 };
 
 // Test case executor implementation